@@ -0,0 +1,51 @@
+#!/usr/bin/perl
+
+# Generates libavfilter/project_embedded.c, which compiles the shaders of
+# ffmpeg360_shader/, the projection math they include (libavfilter/project_math.h)
+# and the layouts of ffmpeg360_layout/ into the filter.
+# Run it from the top directory after changing any of them:
+#   ./embed.pl > libavfilter/project_embedded.c
+
+use 5.018;
+use strict;
+use warnings;
+
+sub embed {
+    my ($table, @patterns) = @_;
+    my @files = map { sort glob($_) } @patterns;
+    my @names;
+
+    for my $path (@files) {
+        open my $fh, "<", $path or die "$path: $!";
+        my $name = $path =~ s{^.*/}{}r;
+        my $var = "${table}_" . ($name =~ s/\W/_/gr);
+        push @names, [$name, $var];
+
+        say "static const char ${var}[] =";
+        while(<$fh>){
+            chomp;
+            s/\r$//;
+            s/\\/\\\\/g;
+            s/"/\\"/g;
+            s/\t/\\t/g;
+            say "    \"$_\\n\"";
+        }
+        say "    ;";
+        say "";
+        close $fh;
+    }
+
+    say "const EmbeddedFile ff_project_${table}[] = {";
+    say "    { \"$_->[0]\", $_->[1] }," for @names;
+    say "    { NULL, NULL },";
+    say "};";
+    say "";
+}
+
+say "/* Generated by embed.pl from ffmpeg360_shader/, project_math.h and ffmpeg360_layout/, do not edit */";
+say "";
+say "#include <stddef.h>";
+say "#include \"project_embedded.h\"";
+say "";
+embed("shaders", "ffmpeg360_shader/*.glsl", "libavfilter/project_math.h");
+embed("layouts", "ffmpeg360_layout/*.lt");
@@ -1,5 +1,35 @@
 #version 330
 
+#define PROJECT_MATH_GLSL
+#include "project_math.h"
+
+// EAC, if defined, renders the faces of an equi-angular cube
+
+#ifndef PLANES
+#define PLANES 1
+#endif
+
+// 2 for the interleaved chroma plane of semi-planar formats, 4 for packed RGB
+#ifndef CHANNELS
+#define CHANNELS 1
+#endif
+// MIPMAP, if defined by the filter, samples with the gradients grad_x and grad_y of main()
+#ifdef MIPMAP
+#define FETCH(tex, uv) textureGrad(tex, uv, grad_x, grad_y)
+#else
+#define FETCH(tex, uv) texture(tex, uv)
+#endif
+#if CHANNELS > 2
+#define TEXEL vec4
+#define SAMPLE(tex, uv) FETCH(tex, uv)
+#elif CHANNELS > 1
+#define TEXEL vec2
+#define SAMPLE(tex, uv) FETCH(tex, uv).rg
+#else
+#define TEXEL float
+#define SAMPLE(tex, uv) FETCH(tex, uv).r
+#endif
+
 in mediump vec2 ex_uv; // absolute u,v
 flat in mediump vec2 wh;
 flat in mediump vec2 corner;
@@ -9,50 +39,61 @@ uniform mediump mat4 ViewMatrix;
 uniform mediump mat4 ProjectionMatrix;
 
 uniform mediump vec2 resolution;
-uniform mediump float fov;
-uniform mediump float yaw;
-uniform mediump float pitch;
-uniform mediump float roll;
+uniform mediump vec2 origin; // lower left corner of the view in the framebuffer
+uniform mediump mat3 rotation; // view orientation Ry(yaw+180) * Rx(-pitch) * Rz(roll), set by the filter
+uniform mediump float focal;   // 0.5/tan(0.5 * radians(fov))
 
-const mediump float M_PI = 3.141592653589793238462643;
-const mediump float M_TWOPI = 6.283185307179586476925286;
-
-out mediump float out_Color;
+layout(location = 0) out mediump TEXEL out_Color;
+#if PLANES > 1
+layout(location = 1) out mediump TEXEL out_Color1;
+#endif
+#if PLANES > 2
+layout(location = 2) out mediump TEXEL out_Color2;
+#endif
 
 uniform sampler2D textureSampler;
-
-mediump mat3 rotationMatrix(mediump vec3 euler)
-{
-    mediump vec3 se = sin(euler);
-    mediump vec3 ce = cos(euler);
-
-    return mat3(ce.y, 0, -se.y, 0, 1, 0, se.y, 0, ce.y) * mat3(1, 0, 0, 0, ce.x, se.x, 0, -se.x, ce.x) * mat3(ce.z,  se.z, 0,-se.z, ce.z, 0, 0, 0, 1);
-}
+#if PLANES > 1
+uniform sampler2D textureSampler1;
+#endif
+#if PLANES > 2
+uniform sampler2D textureSampler2;
+#endif
 
 mediump vec3 toCartesian(mediump vec2 st)
 {
-    return normalize(vec3(st.x, st.y, 0.5/tan(0.5 * radians(fov))));
-}
-
-mediump vec2 toSpherical(mediump vec3 cartesianCoord)
-{
-    mediump vec2 st = vec2(
-        atan(cartesianCoord.x, cartesianCoord.z),
-        acos(cartesianCoord.y)
-        );
-    if(st.x < 0.0)
-        st.x += M_TWOPI;
-
-    return st;
+    return normalize(vec3(st.x, st.y, focal));
 }
 
 void main(void)
 {
-    mediump vec2 sphericalCoord = gl_FragCoord.xy / resolution ;
+    mediump vec2 sphericalCoord = (gl_FragCoord.xy - origin) / resolution ;
     sphericalCoord = sphericalCoord - 0.5 ;
     sphericalCoord.y *= -1;
+#ifdef EAC
+    // equi-angular cube faces
+    sphericalCoord = vec2(pm_eac_warp(sphericalCoord.x), pm_eac_warp(sphericalCoord.y));
+#endif
+
+    mediump vec3 cartesianCoord = rotation * toCartesian(sphericalCoord);
 
-    mediump vec3 cartesianCoord = rotationMatrix(radians(vec3(-pitch, yaw+180., roll))) * toCartesian(sphericalCoord);
+    mediump vec2 uv = vec2(pm_erp_u(cartesianCoord.x, cartesianCoord.z), pm_erp_v(cartesianCoord.y));
+#ifdef MIPMAP
+    // u wraps from 1 to 0 at the seam of the input: there the derivatives of u
+    // shifted by half a turn are the right ones, not a jump selecting the smallest level
+    mediump vec2 grad_x = dFdx(uv), grad_y = dFdy(uv);
+    mediump float shifted = fract(uv.x + 0.5);
+    mediump vec2 shifted_grad = vec2(dFdx(shifted), dFdy(shifted));
+    if(abs(shifted_grad.x) < abs(grad_x.x))
+        grad_x.x = shifted_grad.x;
+    if(abs(shifted_grad.y) < abs(grad_y.x))
+        grad_y.x = shifted_grad.y;
+#endif
 
-    out_Color = texture(textureSampler, toSpherical( cartesianCoord ) / vec2(M_TWOPI, M_PI)).r;
+    out_Color = SAMPLE(textureSampler, uv);
+#if PLANES > 1
+    out_Color1 = SAMPLE(textureSampler1, uv);
+#endif
+#if PLANES > 2
+    out_Color2 = SAMPLE(textureSampler2, uv);
+#endif
 }
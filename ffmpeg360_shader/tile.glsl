@@ -0,0 +1,66 @@
+#version 330
+
+#define PROJECT_MATH_GLSL
+#include "project_math.h"
+
+// how the tiles of the input are sampled, defined by the filter: PM_EQDIS
+// (eqdis.glsl), PM_EQDEG (eqdeg.glsl) or PM_UNEQDEG (uneqdeg.glsl)
+#ifndef PROJECTION
+#define PROJECTION PM_EQDIS
+#endif
+// the expansion coefficient the input tiles were rendered with
+#ifndef ECOEF
+#define ECOEF 1.0
+#endif
+
+#ifndef PLANES
+#define PLANES 1
+#endif
+
+// 2 for the interleaved chroma plane of semi-planar formats, 4 for packed RGB
+#ifndef CHANNELS
+#define CHANNELS 1
+#endif
+#if CHANNELS > 2
+#define TEXEL vec4
+#define SAMPLE(tex, uv) texture(tex, uv)
+#elif CHANNELS > 1
+#define TEXEL vec2
+#define SAMPLE(tex, uv) texture(tex, uv).rg
+#else
+#define TEXEL float
+#define SAMPLE(tex, uv) texture(tex, uv).r
+#endif
+
+in mediump vec2 ex_uv; // absolute u,v
+flat in mediump vec2 wh;
+flat in mediump vec2 corner;
+
+layout(location = 0) out mediump TEXEL out_Color;
+#if PLANES > 1
+layout(location = 1) out mediump TEXEL out_Color1;
+#endif
+#if PLANES > 2
+layout(location = 2) out mediump TEXEL out_Color2;
+#endif
+uniform sampler2D textureSampler;
+#if PLANES > 1
+uniform sampler2D textureSampler1;
+#endif
+#if PLANES > 2
+uniform sampler2D textureSampler2;
+#endif
+
+void main(void)
+{
+    mediump vec2 uv = vec2(pm_tile_sample(PROJECTION, ex_uv.x, corner.x, wh.x / 2.0, ECOEF),
+                           pm_tile_sample(PROJECTION, ex_uv.y, corner.y, wh.y / 2.0, ECOEF));
+
+    out_Color = SAMPLE(textureSampler, uv);
+#if PLANES > 1
+    out_Color1 = SAMPLE(textureSampler1, uv);
+#endif
+#if PLANES > 2
+    out_Color2 = SAMPLE(textureSampler2, uv);
+#endif
+}
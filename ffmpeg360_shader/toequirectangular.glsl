@@ -0,0 +1,128 @@
+#version 330
+
+// Renders an equirectangular frame from the tiles of any input layout. The
+// filter defines TILES, the number of tiles, and like for tile.glsl how they
+// are sampled (PROJECTION) and their expansion coefficient (ECOEF).
+#define PROJECT_MATH_GLSL
+#include "project_math.h"
+
+#ifndef PROJECTION
+#define PROJECTION PM_EQDIS
+#endif
+#ifndef ECOEF
+#define ECOEF 1.0
+#endif
+#ifndef TILES
+#define TILES 6
+#endif
+
+#ifndef PLANES
+#define PLANES 1
+#endif
+
+// 2 for the interleaved chroma plane of semi-planar formats, 4 for packed RGB
+#ifndef CHANNELS
+#define CHANNELS 1
+#endif
+// MIPMAP, if defined by the filter, samples with the gradients grad_x and grad_y of main()
+#ifdef MIPMAP
+#define FETCH(tex, uv) textureGrad(tex, uv, grad_x, grad_y)
+#else
+#define FETCH(tex, uv) texture(tex, uv)
+#endif
+#if CHANNELS > 2
+#define TEXEL vec4
+#define SAMPLE(tex, uv) FETCH(tex, uv)
+#elif CHANNELS > 1
+#define TEXEL vec2
+#define SAMPLE(tex, uv) FETCH(tex, uv).rg
+#else
+#define TEXEL float
+#define SAMPLE(tex, uv) FETCH(tex, uv).r
+#endif
+
+layout(location = 0) out mediump TEXEL out_Color;
+#if PLANES > 1
+layout(location = 1) out mediump TEXEL out_Color1;
+#endif
+#if PLANES > 2
+layout(location = 2) out mediump TEXEL out_Color2;
+#endif
+uniform sampler2D textureSampler;
+#if PLANES > 1
+uniform sampler2D textureSampler1;
+#endif
+#if PLANES > 2
+uniform sampler2D textureSampler2;
+#endif
+
+uniform mediump vec2 resolution;
+uniform mediump vec2 origin; // lower left corner of the view in the framebuffer
+
+// set by the filter for each view
+struct Tile {
+    mediump vec4 rows[3];   // rotation of a direction of the frame into the space of the tile
+    mediump vec4 extent;    // tangents of the half fields of view of the tile
+    mediump vec4 rect;      // u, v, w, h of the tile in the input
+};
+
+layout(std140) uniform Tiles {
+    Tile tiles[TILES];
+};
+
+// direction d in the space of the tile i
+mediump vec3 tileDirection(int i, mediump vec3 d)
+{
+    return vec3(dot(tiles[i].rows[0].xyz, d), dot(tiles[i].rows[1].xyz, d), dot(tiles[i].rows[2].xyz, d));
+}
+
+// texture coordinates where the direction q, in the space of the tile i, hits it
+mediump vec2 tileSample(int i, mediump vec3 q)
+{
+    mediump vec2 ex = tiles[i].rect.xy + vec2(pm_tile_coord(q.x, q.z, tiles[i].extent.x),
+                                              pm_tile_coord(q.y, q.z, tiles[i].extent.y)) * tiles[i].rect.zw;
+
+    return vec2(pm_tile_sample(PROJECTION, ex.x, tiles[i].rect.x, tiles[i].rect.z / 2.0, ECOEF),
+                pm_tile_sample(PROJECTION, ex.y, tiles[i].rect.y, tiles[i].rect.w / 2.0, ECOEF));
+}
+
+void main(void)
+{
+    mediump vec2 fc = (gl_FragCoord.xy - origin) / resolution;
+    mediump vec3 dir = vec3(pm_erp_x(fc.x, fc.y), pm_erp_y(fc.x, fc.y), pm_erp_z(fc.x, fc.y));
+#ifdef MIPMAP
+    // neighbouring pixels may sample other tiles: the gradients follow the
+    // direction, which is continuous, through the tile of this pixel
+    mediump vec3 dir_dx = dFdx(dir), dir_dy = dFdy(dir);
+#endif
+    mediump vec3 q;
+    mediump vec2 ab;
+    mediump vec2 uv;
+    int i;
+
+    // the tile drawn last covers the others, like when the tiles are rendered as views
+    for(i = TILES - 1; i >= 0; i--){
+        q = tileDirection(i, dir);
+        if(q.z >= 0.0)
+            continue;
+        ab = vec2(pm_tile_coord(q.x, q.z, tiles[i].extent.x), pm_tile_coord(q.y, q.z, tiles[i].extent.y));
+        if(all(greaterThanEqual(ab, vec2(0.0))) && all(lessThanEqual(ab, vec2(1.0))))
+            break;
+    }
+    if(i < 0)
+        discard;
+
+    uv = tileSample(i, q);
+#ifdef MIPMAP
+    mediump vec2 grad_x = tileSample(i, tileDirection(i, dir + dir_dx)) - uv;
+    mediump vec2 grad_y = tileSample(i, tileDirection(i, dir + dir_dy)) - uv;
+#endif
+
+    out_Color = SAMPLE(textureSampler, uv);
+#if PLANES > 1
+    out_Color1 = SAMPLE(textureSampler1, uv);
+#endif
+#if PLANES > 2
+    out_Color2 = SAMPLE(textureSampler2, uv);
+#endif
+}
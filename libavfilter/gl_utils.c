@@ -1,4 +1,11 @@
+#include <unistd.h>
+#include <sys/stat.h>
 #include "gl_utils.h"
+#include "project_embedded.h"
+#include "libavutil/avstring.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem.h"
+#include "libavutil/sha.h"
 
 const Matrix IDENTITY_MATRIX = {
     {
@@ -141,6 +148,89 @@ Matrix CreateProjectionMatrix(float fovx, float fovy, float near_plane, float fa
     return out;
 }
 
+static Quaternion MultiplyQuaternions(const Quaternion *q1, const Quaternion *q2)
+{
+    Quaternion out;
+
+    out.w = q1->w * q2->w - q1->x * q2->x - q1->y * q2->y - q1->z * q2->z;
+    out.x = q1->w * q2->x + q1->x * q2->w + q1->y * q2->z - q1->z * q2->y;
+    out.y = q1->w * q2->y - q1->x * q2->z + q1->y * q2->w + q1->z * q2->x;
+    out.z = q1->w * q2->z + q1->x * q2->y - q1->y * q2->x + q1->z * q2->w;
+
+    return out;
+}
+
+/*
+ * degrees holds the x, y and z rotations as applied by RotateAboutY(),
+ * RotateAboutX() and RotateAboutZ() in this order. Those rotate by the
+ * negated angle, which is why the halves below are negated as well.
+ */
+Quaternion EulerToQuaternion(const double degrees[3])
+{
+    const double hx = -0.5 * degrees[0] * PI / 180;
+    const double hy = -0.5 * degrees[1] * PI / 180;
+    const double hz = -0.5 * degrees[2] * PI / 180;
+    const Quaternion qx = { cos(hx), sin(hx), 0, 0 };
+    const Quaternion qy = { cos(hy), 0, sin(hy), 0 };
+    const Quaternion qz = { cos(hz), 0, 0, sin(hz) };
+    Quaternion out;
+
+    out = MultiplyQuaternions(&qy, &qx);
+    return MultiplyQuaternions(&out, &qz);
+}
+
+void QuaternionToEuler(const Quaternion *q, double degrees[3])
+{
+    // rotation matrix entries needed by the Y * X * Z decomposition
+    const double r12 = 2 * (q->y * q->z - q->w * q->x);
+    const double r02 = 2 * (q->x * q->z + q->w * q->y);
+    const double r22 = 1 - 2 * (q->x * q->x + q->y * q->y);
+    const double r10 = 2 * (q->x * q->y + q->w * q->z);
+    const double r11 = 1 - 2 * (q->x * q->x + q->z * q->z);
+
+    degrees[0] = -asin(fmax(-1.0, fmin(1.0, -r12))) * 180 / PI;
+    degrees[1] = -atan2(r02, r22) * 180 / PI;
+    degrees[2] = -atan2(r10, r11) * 180 / PI;
+}
+
+Quaternion SlerpQuaternions(const Quaternion *q1, const Quaternion *q2, double t)
+{
+    Quaternion out, end = *q2;
+    double cosine = q1->w * q2->w + q1->x * q2->x + q1->y * q2->y + q1->z * q2->z;
+    double angle, k1, k2, norm;
+
+    // take the short way around
+    if(cosine < 0){
+        cosine = -cosine;
+        end.w = -end.w;
+        end.x = -end.x;
+        end.y = -end.y;
+        end.z = -end.z;
+    }
+
+    if(cosine > 0.9995){
+        k1 = 1 - t;
+        k2 = t;
+    }else{
+        angle = acos(cosine);
+        k1 = sin((1 - t) * angle) / sin(angle);
+        k2 = sin(t * angle) / sin(angle);
+    }
+
+    out.w = k1 * q1->w + k2 * end.w;
+    out.x = k1 * q1->x + k2 * end.x;
+    out.y = k1 * q1->y + k2 * end.y;
+    out.z = k1 * q1->z + k2 * end.z;
+
+    norm = sqrt(out.w * out.w + out.x * out.x + out.y * out.y + out.z * out.z);
+    out.w /= norm;
+    out.x /= norm;
+    out.y /= norm;
+    out.z /= norm;
+
+    return out;
+}
+
 void ExitOnGLError(void *avctx, const char *error_message)
 {
     const GLenum ErrorValue = glGetError();
@@ -163,14 +253,20 @@ int CheckGLError(void *avctx, const char *error_message)
     }
 }
 
-GLuint LoadShader(void *avctx, const char *filename, GLenum shader_type)
+// Get a shader built into the filter, or read one of ffmpeg360_shader/, as a malloc()ed string
+static char *ReadSourceFile(void *avctx, const char *filename)
 {
-    GLuint shader_id = 0;
-    GLint compRes = 0, logSize = 0;
-    GLchar *log;
     FILE *file;
     long file_size = -1;
-    char *glsl_source;
+    char *glsl_source = NULL;
+    int i;
+
+    for(i = 0; ff_project_shaders[i].name; i++){
+        if(!strcmp(filename, ff_project_shaders[i].name)){
+            av_log(avctx, AV_LOG_VERBOSE, "[OpenGL] using the built-in shader %s\n", filename);
+            return strdup(ff_project_shaders[i].data);
+        }
+    }
 
     av_log(avctx, AV_LOG_INFO, "[OpenGL] Try loading shader file %s... \n", filename);
 
@@ -187,27 +283,13 @@ GLuint LoadShader(void *avctx, const char *filename, GLenum shader_type)
         rewind(file);
 
         if(NULL != (glsl_source = (char *)malloc(file_size+1))){
-            if(file_size == (long)fread(glsl_source, sizeof(char), file_size, file)){
+            if(file_size == (long)fread(glsl_source, sizeof(char), file_size, file))
                 glsl_source[file_size] = '\0';
-
-                if(0 != (shader_id = glCreateShader(shader_type))){
-                    glShaderSource(shader_id, 1, (const GLchar **)(&glsl_source), NULL);
-                    glCompileShader(shader_id);
-                    glGetShaderiv(shader_id, GL_COMPILE_STATUS, &compRes);
-                    if(GL_FALSE == compRes){
-                        av_log(avctx, AV_LOG_ERROR, "[OpenGL] compiling %s failed: \n", filename);
-                        glGetShaderiv(shader_id, GL_INFO_LOG_LENGTH, &logSize);
-                        log = malloc(logSize * sizeof(GLchar));
-                        glGetShaderInfoLog(shader_id, logSize, NULL, log);
-                        av_log(avctx, AV_LOG_ERROR, "[OpenGL] \n%s\n", log);
-                        free(log);
-                    }
-                }else
-                    av_log(avctx, AV_LOG_ERROR, "[OpenGL] Could not create a shader");
-            }else
+            else{
                 av_log(avctx, AV_LOG_ERROR, "[OpenGL] ERROR: Could not read a file");
-
-            free(glsl_source);
+                free(glsl_source);
+                glsl_source = NULL;
+            }
         }else
             av_log(avctx, AV_LOG_ERROR, "[OpenGL] ERROR: Could not allocate %ld bytes.\n", file_size);
 
@@ -219,5 +301,631 @@ GLuint LoadShader(void *avctx, const char *filename, GLenum shader_type)
     }
 
     free(shader_path);
+    return glsl_source;
+}
+
+/*
+ * Reads a shader and inlines the files of its #include "name" lines, looked up
+ * like shaders; the built-in ones include project_math.h. Included files are not
+ * expanded further.
+ */
+static char *ReadShaderFile(void *avctx, const char *filename)
+{
+    char *glsl_source, *included, *expanded, *line, *name, *end;
+    size_t size, offset = 0;
+
+    if(!(glsl_source = ReadSourceFile(avctx, filename)))
+        return NULL;
+
+    while(line = strstr(glsl_source + offset, "#include \"")){
+        offset = line - glsl_source + 1;
+        if(line != glsl_source && line[-1] != '\n')
+            continue;
+        name = line + 10;
+        if(!(end = strchr(name, '"'))){
+            av_log(avctx, AV_LOG_ERROR, "[OpenGL] ERROR: Malformed #include in %s\n", filename);
+            free(glsl_source);
+            return NULL;
+        }
+        *end = '\0';
+        if(!(included = ReadSourceFile(avctx, name))){
+            free(glsl_source);
+            return NULL;
+        }
+        end++;
+        offset = (line - glsl_source) + strlen(included);
+        size = offset + strlen(end) + 1;
+        if(expanded = malloc(size)){
+            *line = '\0';
+            snprintf(expanded, size, "%s%s%s", glsl_source, included, end);
+        }else
+            av_log(avctx, AV_LOG_ERROR, "[OpenGL] ERROR: Could not allocate %zu bytes.\n", size);
+        free(included);
+        free(glsl_source);
+        if(!(glsl_source = expanded))
+            return NULL;
+    }
+    return glsl_source;
+}
+
+// defines, if not NULL, are inserted right after the #version line of the source
+static GLuint CompileShader(void *avctx, const char *filename, const char *glsl_source, GLenum shader_type, const char *defines)
+{
+    GLuint shader_id;
+    GLint compRes = 0, logSize = 0;
+    GLchar *log;
+    const GLchar *sources[3];
+    GLint lengths[3];
+    const char *body;
+
+    if(0 != (shader_id = glCreateShader(shader_type))){
+        body = glsl_source;
+        if(!strncmp(body, "#version", 8) && (body = strchr(body, '\n')))
+            body++;
+        else
+            body = glsl_source;
+        sources[0] = glsl_source;
+        lengths[0] = body - glsl_source;
+        sources[1] = defines ? defines : "";
+        lengths[1] = -1;
+        sources[2] = body;
+        lengths[2] = -1;
+        glShaderSource(shader_id, 3, sources, lengths);
+        glCompileShader(shader_id);
+        glGetShaderiv(shader_id, GL_COMPILE_STATUS, &compRes);
+        if(GL_FALSE == compRes){
+            av_log(avctx, AV_LOG_ERROR, "[OpenGL] compiling %s failed: \n", filename);
+            glGetShaderiv(shader_id, GL_INFO_LOG_LENGTH, &logSize);
+            log = malloc(logSize * sizeof(GLchar));
+            glGetShaderInfoLog(shader_id, logSize, NULL, log);
+            av_log(avctx, AV_LOG_ERROR, "[OpenGL] \n%s\n", log);
+            free(log);
+        }
+    }else
+        av_log(avctx, AV_LOG_ERROR, "[OpenGL] Could not create a shader");
+
     return shader_id;
 }
+
+/*
+ * All filter instances share one GL context. It is created by the first
+ * AcquireGLContext() and destroyed with the last reference: a headless EGL
+ * context where available, a hidden GLFW window otherwise. The recursive mutex
+ * serializes the GL calls of all instances; the context is current on the
+ * thread holding it.
+ */
+typedef struct SharedProgram {
+    struct SharedProgram *next;
+    char *vshader, *fshader, *defines;
+    GLuint ids[3];      ///< program, fragment shader, vertex shader; no shaders when loaded from a binary
+    int refs;
+} SharedProgram;
+
+static pthread_once_t gl_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t gl_mutex;
+static GLFWwindow *gl_window;
+#if !defined(__APPLE__)
+static EGLDisplay egl_display = EGL_NO_DISPLAY;
+static EGLSurface egl_surface = EGL_NO_SURFACE;  ///< 1x1 pbuffer, unless the context is surfaceless
+static EGLContext egl_context = EGL_NO_CONTEXT;
+#endif
+static int gl_refs;
+static int gl_depth;
+static SharedProgram *gl_programs;
+
+static void InitGLMutex(void)
+{
+    pthread_mutexattr_t attr;
+
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&gl_mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+static void MakeContextCurrent(int current)
+{
+#if !defined(__APPLE__)
+    if(egl_context != EGL_NO_CONTEXT){
+        if(current)
+            eglMakeCurrent(egl_display, egl_surface, egl_surface, egl_context);
+        else
+            eglMakeCurrent(egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        return;
+    }
+#endif
+    glfwMakeContextCurrent(current ? gl_window : NULL);
+}
+
+static void DestroyContext(void)
+{
+#if !defined(__APPLE__)
+    if(egl_display != EGL_NO_DISPLAY){
+        eglMakeCurrent(egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if(egl_context != EGL_NO_CONTEXT)
+            eglDestroyContext(egl_display, egl_context);
+        if(egl_surface != EGL_NO_SURFACE)
+            eglDestroySurface(egl_display, egl_surface);
+        eglTerminate(egl_display);
+        egl_display = EGL_NO_DISPLAY;
+        egl_surface = EGL_NO_SURFACE;
+        egl_context = EGL_NO_CONTEXT;
+        return;
+    }
+#endif
+    if(gl_window){
+        glfwDestroyWindow(gl_window);
+        glfwTerminate();
+        gl_window = NULL;
+    }
+}
+
+#if !defined(__APPLE__)
+static int HasExtension(const char *extensions, const char *name)
+{
+    const size_t len = strlen(name);
+    const char *p = extensions;
+
+    while(p && (p = strstr(p, name))){
+        if((p == extensions || p[-1] == ' ') && (p[len] == ' ' || !p[len]))
+            return 1;
+        p += len;
+    }
+    return 0;
+}
+
+// Headless context without a window system, e.g. Mesa's llvmpipe on a server without X
+static int CreateEGLContext(void *avctx)
+{
+    const char *client_extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    PFNEGLGETPLATFORMDISPLAYEXTPROC GetPlatformDisplay = NULL;
+    const EGLint pbuffer_config[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8,
+        EGL_NONE
+    };
+    const EGLint surfaceless_config[] = {
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+    const EGLint context_attribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION_KHR, 3,
+        EGL_CONTEXT_MINOR_VERSION_KHR, 2,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK_KHR, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT_KHR,
+        EGL_NONE
+    };
+    const EGLint pbuffer_attribs[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+    EGLint major, minor, nb_configs = 0;
+    EGLConfig config;
+    int surfaceless;
+
+    // the surfaceless platform needs no display server at all
+    if(HasExtension(client_extensions, "EGL_MESA_platform_surfaceless") &&
+       HasExtension(client_extensions, "EGL_EXT_platform_base"))
+        GetPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if(GetPlatformDisplay)
+        egl_display = GetPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    if(egl_display == EGL_NO_DISPLAY)
+        egl_display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if(egl_display == EGL_NO_DISPLAY || !eglInitialize(egl_display, &major, &minor)){
+        av_log(avctx, AV_LOG_VERBOSE, "[OpenGL] no EGL display\n");
+        egl_display = EGL_NO_DISPLAY;
+        return -1;
+    }
+    if(!eglBindAPI(EGL_OPENGL_API)){
+        av_log(avctx, AV_LOG_VERBOSE, "[OpenGL] EGL %d.%d does not support desktop OpenGL\n", major, minor);
+        DestroyContext();
+        return -1;
+    }
+
+    surfaceless = HasExtension(eglQueryString(egl_display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context");
+    if((!eglChooseConfig(egl_display, pbuffer_config, &config, 1, &nb_configs) || !nb_configs) &&
+       (!surfaceless || !eglChooseConfig(egl_display, surfaceless_config, &config, 1, &nb_configs) || !nb_configs)){
+        av_log(avctx, AV_LOG_VERBOSE, "[OpenGL] no EGL config for OpenGL rendering\n");
+        DestroyContext();
+        return -1;
+    }
+
+    egl_context = eglCreateContext(egl_display, config, EGL_NO_CONTEXT, context_attribs);
+    if(egl_context == EGL_NO_CONTEXT){
+        av_log(avctx, AV_LOG_VERBOSE, "[OpenGL] could not create an OpenGL 3.2 core context with EGL (0x%x)\n", eglGetError());
+        DestroyContext();
+        return -1;
+    }
+    // rendering goes to framebuffer objects, the surface only has to exist
+    if(!surfaceless &&
+       (egl_surface = eglCreatePbufferSurface(egl_display, config, pbuffer_attribs)) == EGL_NO_SURFACE){
+        av_log(avctx, AV_LOG_VERBOSE, "[OpenGL] could not create an EGL pbuffer (0x%x)\n", eglGetError());
+        DestroyContext();
+        return -1;
+    }
+    if(!eglMakeCurrent(egl_display, egl_surface, egl_surface, egl_context)){
+        av_log(avctx, AV_LOG_VERBOSE, "[OpenGL] could not make the EGL context current (0x%x)\n", eglGetError());
+        DestroyContext();
+        return -1;
+    }
+
+    av_log(avctx, AV_LOG_INFO, "[OpenGL] headless EGL %d.%d context%s\n", major, minor, surfaceless ? ", surfaceless" : " on a pbuffer");
+    return 0;
+}
+#endif
+
+static int CreateGLFWContext(void *avctx)
+{
+    if(!glfwInit()){
+        av_log(avctx, AV_LOG_ERROR, "[OpenGL] ERROR: could not initialize GLFW3\n");
+        return -1;
+    }
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 2);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    gl_window = glfwCreateWindow(640, 640, "OpenGL", NULL, NULL);
+    if(!gl_window){
+        av_log(avctx, AV_LOG_ERROR, "[OpenGL] ERROR: could not open window with GLFW3\n");
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(gl_window);
+    return 0;
+}
+
+static int CreateSharedContext(void *avctx)
+{
+    GLenum GlewInitResult;
+
+#if !defined(__APPLE__)
+    if(CreateEGLContext(avctx) && CreateGLFWContext(avctx))
+        return -1;
+#else
+    if(CreateGLFWContext(avctx))
+        return -1;
+#endif
+
+    glewExperimental = GL_TRUE;
+    GlewInitResult = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+    // a GLX build of GLEW finds no X display behind an EGL context, but still loads the GL functions
+    if(GlewInitResult == GLEW_ERROR_NO_GLX_DISPLAY)
+        GlewInitResult = GLEW_OK;
+#endif
+    if(GLEW_OK != GlewInitResult){
+        av_log(avctx, AV_LOG_ERROR, "[OpenGL] GLEW initialization failed: %s\n", glewGetErrorString(GlewInitResult));
+        DestroyContext();
+        return -1;
+    }
+
+    av_log(avctx, AV_LOG_INFO, "[OpenGL] OpenGL Version: %s\n", glGetString(GL_VERSION));
+
+    glGetError();
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);
+
+    MakeContextCurrent(0);
+    return 0;
+}
+
+int AcquireGLContext(void *avctx)
+{
+    int ret = 0;
+
+    pthread_once(&gl_once, InitGLMutex);
+    pthread_mutex_lock(&gl_mutex);
+    if(!gl_refs)
+        ret = CreateSharedContext(avctx);
+    if(!ret)
+        gl_refs++;
+    pthread_mutex_unlock(&gl_mutex);
+
+    return ret;
+}
+
+void ReleaseGLContext(void *avctx)
+{
+    SharedProgram *p;
+
+    pthread_mutex_lock(&gl_mutex);
+    if(gl_refs > 0 && !--gl_refs){
+        av_log(avctx, AV_LOG_INFO, "[OpenGL] destroying the shared context\n");
+        // programs still cached go with the context
+        while(p = gl_programs){
+            gl_programs = p->next;
+            free(p->vshader);
+            free(p->fshader);
+            free(p->defines);
+            free(p);
+        }
+        DestroyContext();
+    }
+    pthread_mutex_unlock(&gl_mutex);
+}
+
+void LockGLContext(void)
+{
+    pthread_mutex_lock(&gl_mutex);
+    if(!gl_depth++)
+        MakeContextCurrent(1);
+}
+
+void UnlockGLContext(void)
+{
+    // let other threads make the context current
+    if(!--gl_depth)
+        MakeContextCurrent(0);
+    pthread_mutex_unlock(&gl_mutex);
+}
+
+static int SameString(const char *a, const char *b)
+{
+    return a == b || (a && b && !strcmp(a, b));
+}
+
+/*
+ * Linked programs are kept in the cache directory as <key>.glbin: the magic,
+ * the key, the binary format and the driver's program binary. The key hashes
+ * the shader sources, the defines and the GL vendor, renderer and version, so
+ * a driver update or another GPU never sees a stale binary.
+ */
+#define PROGRAM_MAGIC "P360GLB1"
+#define PROGRAM_KEY_SIZE 32
+#define PROGRAM_HEADER_SIZE (8 + PROGRAM_KEY_SIZE + 8)
+
+static int ProgramCacheKey(const char *vsource, const char *fsource, const char *defines, uint8_t key[PROGRAM_KEY_SIZE])
+{
+    const char *strings[6];
+    struct AVSHA *sha;
+    uint8_t len[4];
+    int i;
+
+    if(!(sha = av_sha_alloc()))
+        return ENOMEM;
+    av_sha_init(sha, 256);
+
+    strings[0] = vsource;
+    strings[1] = fsource;
+    strings[2] = defines ? defines : "";
+    strings[3] = (const char *)glGetString(GL_VENDOR);
+    strings[4] = (const char *)glGetString(GL_RENDERER);
+    strings[5] = (const char *)glGetString(GL_VERSION);
+    for(i = 0; i < 6; i++){
+        if(!strings[i])
+            strings[i] = "";
+        // length prefixed, so the strings cannot shift into each other
+        AV_WL32(len, strlen(strings[i]));
+        av_sha_update(sha, len, sizeof(len));
+        av_sha_update(sha, (const uint8_t *)strings[i], strlen(strings[i]));
+    }
+
+    av_sha_final(sha, key);
+    av_free(sha);
+    return 0;
+}
+
+static char *ProgramCachePath(const char *cachedir, const uint8_t key[PROGRAM_KEY_SIZE])
+{
+    char hex[2 * PROGRAM_KEY_SIZE + 1];
+    int i;
+
+    for(i = 0; i < PROGRAM_KEY_SIZE; i++)
+        snprintf(hex + 2 * i, 3, "%02x", key[i]);
+    return av_asprintf("%s/%s.glbin", cachedir, hex);
+}
+
+// Create the program from a cached binary, returns 0 when there is none or the driver rejects it
+static GLuint LoadProgramBinary(void *avctx, const char *path, const uint8_t key[PROGRAM_KEY_SIZE])
+{
+    uint8_t header[PROGRAM_HEADER_SIZE];
+    GLuint program = 0;
+    GLint linkRes = 0;
+    uint8_t *binary;
+    long size;
+    FILE *fp;
+
+    if(!(fp = fopen(path, "rb")))
+        return 0;
+    if(fseek(fp, 0, SEEK_END) || (size = ftell(fp)) <= PROGRAM_HEADER_SIZE || fseek(fp, 0, SEEK_SET) ||
+       fread(header, sizeof(header), 1, fp) != 1 ||
+       memcmp(header, PROGRAM_MAGIC, 8) || memcmp(header + 8, key, PROGRAM_KEY_SIZE)){
+        av_log(avctx, AV_LOG_WARNING, "[OpenGL] %s is not a program binary of these shaders, compiling them\n", path);
+        fclose(fp);
+        return 0;
+    }
+    size -= PROGRAM_HEADER_SIZE;
+    if(!(binary = malloc(size)) || fread(binary, size, 1, fp) != 1){
+        fclose(fp);
+        free(binary);
+        return 0;
+    }
+    fclose(fp);
+
+    if(program = glCreateProgram()){
+        glProgramBinary(program, AV_RL32(header + 8 + PROGRAM_KEY_SIZE), binary, size);
+        glGetProgramiv(program, GL_LINK_STATUS, &linkRes);
+        if(GL_FALSE == linkRes){
+            // e.g. the driver changed its binary format without changing its version string
+            av_log(avctx, AV_LOG_VERBOSE, "[OpenGL] the driver rejected the program binary %s, compiling the shaders\n", path);
+            glDeleteProgram(program);
+            program = 0;
+        }
+    }
+    // a rejected binary may leave an error behind
+    while(glGetError() != GL_NO_ERROR);
+    free(binary);
+
+    if(program)
+        av_log(avctx, AV_LOG_INFO, "[OpenGL] loaded the program binary %s\n", path);
+    return program;
+}
+
+// Store the linked program; written to a temporary file and renamed, so readers never see a partial file
+static void SaveProgramBinary(void *avctx, GLuint program, const char *path, const uint8_t key[PROGRAM_KEY_SIZE])
+{
+    uint8_t header[PROGRAM_HEADER_SIZE] = { 0 };
+    GLint size = 0;
+    GLenum format = 0;
+    uint8_t *binary;
+    char *tmp;
+    FILE *fp;
+    int fd, ok;
+
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size);
+    if(size <= 0 || !(binary = malloc(size)))
+        return;
+    glGetProgramBinary(program, size, &size, &format, binary);
+    if(CheckGLError(avctx, "WARNING: Could not get the program binary") || size <= 0){
+        free(binary);
+        return;
+    }
+
+    if(!(tmp = av_asprintf("%s.XXXXXX", path))){
+        free(binary);
+        return;
+    }
+    if((fd = mkstemp(tmp)) < 0 || !(fp = fdopen(fd, "wb"))){
+        av_log(avctx, AV_LOG_WARNING, "[OpenGL] Failed to create %s\n", tmp);
+        if(fd >= 0){
+            close(fd);
+            unlink(tmp);
+        }
+        av_free(tmp);
+        free(binary);
+        return;
+    }
+    fchmod(fd, 0644);
+
+    memcpy(header, PROGRAM_MAGIC, 8);
+    memcpy(header + 8, key, PROGRAM_KEY_SIZE);
+    AV_WL32(header + 8 + PROGRAM_KEY_SIZE, format);
+    ok = fwrite(header, sizeof(header), 1, fp) == 1;
+    ok &= fwrite(binary, size, 1, fp) == 1;
+    ok &= !fclose(fp);
+
+    if(!ok || rename(tmp, path)){
+        av_log(avctx, AV_LOG_WARNING, "[OpenGL] Failed to write %s\n", path);
+        unlink(tmp);
+    }else
+        av_log(avctx, AV_LOG_INFO, "[OpenGL] stored the program binary %s\n", path);
+    av_free(tmp);
+    free(binary);
+}
+
+// Must be called with the context locked
+GLuint AcquireProgram(void *avctx, const char *vshader, const char *fshader, const char *defines, const char *cachedir)
+{
+    SharedProgram *p;
+    GLint linkRes = 0, logSize = 0;
+    GLchar *log;
+    char *vsource = NULL, *fsource = NULL, *path = NULL;
+    uint8_t key[PROGRAM_KEY_SIZE];
+
+    for(p = gl_programs; p; p = p->next){
+        if(!strcmp(p->vshader, vshader) && !strcmp(p->fshader, fshader) && SameString(p->defines, defines)){
+            p->refs++;
+            return p->ids[0];
+        }
+    }
+
+    if(!(p = calloc(1, sizeof(*p))))
+        return 0;
+
+    if(!(fsource = ReadShaderFile(avctx, fshader)) || !(vsource = ReadShaderFile(avctx, vshader)))
+        goto fail;
+
+    // program binaries need OpenGL 4.1 or ARB_get_program_binary, and a driver supporting at least one format
+    if(cachedir && *cachedir && GLEW_ARB_get_program_binary){
+        GLint formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        if(formats > 0 && !ProgramCacheKey(vsource, fsource, defines, key))
+            path = ProgramCachePath(cachedir, key);
+    }
+    if(path && (p->ids[0] = LoadProgramBinary(avctx, path, key)))
+        goto done;
+
+    p->ids[0] = glCreateProgram();
+    p->ids[1] = CompileShader(avctx, fshader, fsource, GL_FRAGMENT_SHADER, defines);
+    p->ids[2] = CompileShader(avctx, vshader, vsource, GL_VERTEX_SHADER, NULL);
+    if(!p->ids[0] || !p->ids[1] || !p->ids[2])
+        goto fail;
+
+    glAttachShader(p->ids[0], p->ids[1]);
+    glAttachShader(p->ids[0], p->ids[2]);
+    if(path)
+        glProgramParameteri(p->ids[0], GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(p->ids[0]);
+    glGetProgramiv(p->ids[0], GL_LINK_STATUS, &linkRes);
+    if(GL_FALSE == linkRes){
+        av_log(avctx, AV_LOG_ERROR, "[OpenGL] linking %s and %s failed: \n", vshader, fshader);
+        glGetProgramiv(p->ids[0], GL_INFO_LOG_LENGTH, &logSize);
+        log = malloc(logSize * sizeof(GLchar));
+        glGetProgramInfoLog(p->ids[0], logSize, NULL, log);
+        av_log(avctx, AV_LOG_ERROR, "[OpenGL] \n%s\n", log);
+        free(log);
+        goto fail;
+    }
+    if(path)
+        SaveProgramBinary(avctx, p->ids[0], path, key);
+
+done:
+    free(vsource);
+    free(fsource);
+    av_free(path);
+    p->vshader = strdup(vshader);
+    p->fshader = strdup(fshader);
+    p->defines = defines ? strdup(defines) : NULL;
+    if(!p->vshader || !p->fshader || (defines && !p->defines))
+        goto fail;
+
+    p->refs = 1;
+    p->next = gl_programs;
+    gl_programs = p;
+    return p->ids[0];
+
+fail:
+    free(vsource);
+    free(fsource);
+    av_free(path);
+    if(p->ids[1])
+        glDeleteShader(p->ids[1]);
+    if(p->ids[2])
+        glDeleteShader(p->ids[2]);
+    if(p->ids[0])
+        glDeleteProgram(p->ids[0]);
+    free(p->vshader);
+    free(p->fshader);
+    free(p->defines);
+    free(p);
+    return 0;
+}
+
+// Must be called with the context locked
+void ReleaseProgram(void *avctx, GLuint program)
+{
+    SharedProgram **pp, *p;
+
+    for(pp = &gl_programs; p = *pp; pp = &p->next){
+        if(p->ids[0] != program)
+            continue;
+        if(--p->refs)
+            return;
+
+        *pp = p->next;
+        if(p->ids[1]){
+            glDetachShader(p->ids[0], p->ids[1]);
+            glDetachShader(p->ids[0], p->ids[2]);
+            glDeleteShader(p->ids[1]);
+            glDeleteShader(p->ids[2]);
+        }
+        glDeleteProgram(p->ids[0]);
+        CheckGLError(avctx, "ERROR: Could not destroy the program objects");
+        free(p->vshader);
+        free(p->fshader);
+        free(p->defines);
+        free(p);
+        return;
+    }
+}
@@ -6,9 +6,14 @@
 #include <string.h>
 #include <math.h>
 #include <time.h>
+#include <pthread.h>
 #include <GL/glew.h>
 //#include <GL/freeglut.h>
 #include <GLFW/glfw3.h>
+#if !defined(__APPLE__)
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
 #include "libavutil/log.h"
 
 #include <stdint.h>
@@ -33,6 +38,10 @@ typedef struct Matrix {
     float m[16];
 } Matrix;
 
+typedef struct Quaternion {
+    double w, x, y, z;
+} Quaternion;
+
 extern const Matrix IDENTITY_MATRIX;
 
 float Cotangent(float angle);
@@ -50,9 +59,23 @@ void TranslateMatrix(Matrix *m, float x, float y, float z);
 
 Matrix CreateProjectionMatrix(float fovx, float fovy, float near_plane, float far_plane);
 
+Quaternion EulerToQuaternion(const double degrees[3]);
+void QuaternionToEuler(const Quaternion *q, double degrees[3]);
+Quaternion SlerpQuaternions(const Quaternion *q1, const Quaternion *q2, double t);
+
 void ExitOnGLError(void *avctx, const char *error_message);
 int CheckGLError(void *avctx, const char *error_message);
-GLuint LoadShader(void *avctx, const char* filename, GLenum shader_type);
+
+// process-wide GL context shared by all filter instances
+int AcquireGLContext(void *avctx);
+void ReleaseGLContext(void *avctx);
+void LockGLContext(void);
+void UnlockGLContext(void);
+
+// programs are cached by shader files and defines, and shared between instances;
+// with a cachedir, linked program binaries are also reused across runs
+GLuint AcquireProgram(void *avctx, const char *vshader, const char *fshader, const char *defines, const char *cachedir);
+void ReleaseProgram(void *avctx, GLuint program);
 
 
 
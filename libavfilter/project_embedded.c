@@ -0,0 +1,736 @@
+/* Generated by embed.pl from ffmpeg360_shader/, project_math.h and ffmpeg360_layout/, do not edit */
+
+#include <stddef.h>
+#include "project_embedded.h"
+
+static const char shaders_equirectangular_glsl[] =
+    "#version 330\n"
+    "\n"
+    "#define PROJECT_MATH_GLSL\n"
+    "#include \"project_math.h\"\n"
+    "\n"
+    "// EAC, if defined, renders the faces of an equi-angular cube\n"
+    "\n"
+    "#ifndef PLANES\n"
+    "#define PLANES 1\n"
+    "#endif\n"
+    "\n"
+    "// 2 for the interleaved chroma plane of semi-planar formats, 4 for packed RGB\n"
+    "#ifndef CHANNELS\n"
+    "#define CHANNELS 1\n"
+    "#endif\n"
+    "// MIPMAP, if defined by the filter, samples with the gradients grad_x and grad_y of main()\n"
+    "#ifdef MIPMAP\n"
+    "#define FETCH(tex, uv) textureGrad(tex, uv, grad_x, grad_y)\n"
+    "#else\n"
+    "#define FETCH(tex, uv) texture(tex, uv)\n"
+    "#endif\n"
+    "#if CHANNELS > 2\n"
+    "#define TEXEL vec4\n"
+    "#define SAMPLE(tex, uv) FETCH(tex, uv)\n"
+    "#elif CHANNELS > 1\n"
+    "#define TEXEL vec2\n"
+    "#define SAMPLE(tex, uv) FETCH(tex, uv).rg\n"
+    "#else\n"
+    "#define TEXEL float\n"
+    "#define SAMPLE(tex, uv) FETCH(tex, uv).r\n"
+    "#endif\n"
+    "\n"
+    "in mediump vec2 ex_uv; // absolute u,v\n"
+    "flat in mediump vec2 wh;\n"
+    "flat in mediump vec2 corner;\n"
+    "\n"
+    "uniform mediump mat4 ModelMatrix;\n"
+    "uniform mediump mat4 ViewMatrix;\n"
+    "uniform mediump mat4 ProjectionMatrix;\n"
+    "\n"
+    "uniform mediump vec2 resolution;\n"
+    "uniform mediump vec2 origin; // lower left corner of the view in the framebuffer\n"
+    "uniform mediump mat3 rotation; // view orientation Ry(yaw+180) * Rx(-pitch) * Rz(roll), set by the filter\n"
+    "uniform mediump float focal;   // 0.5/tan(0.5 * radians(fov))\n"
+    "\n"
+    "layout(location = 0) out mediump TEXEL out_Color;\n"
+    "#if PLANES > 1\n"
+    "layout(location = 1) out mediump TEXEL out_Color1;\n"
+    "#endif\n"
+    "#if PLANES > 2\n"
+    "layout(location = 2) out mediump TEXEL out_Color2;\n"
+    "#endif\n"
+    "\n"
+    "uniform sampler2D textureSampler;\n"
+    "#if PLANES > 1\n"
+    "uniform sampler2D textureSampler1;\n"
+    "#endif\n"
+    "#if PLANES > 2\n"
+    "uniform sampler2D textureSampler2;\n"
+    "#endif\n"
+    "\n"
+    "mediump vec3 toCartesian(mediump vec2 st)\n"
+    "{\n"
+    "    return normalize(vec3(st.x, st.y, focal));\n"
+    "}\n"
+    "\n"
+    "void main(void)\n"
+    "{\n"
+    "    mediump vec2 sphericalCoord = (gl_FragCoord.xy - origin) / resolution ;\n"
+    "    sphericalCoord = sphericalCoord - 0.5 ;\n"
+    "    sphericalCoord.y *= -1;\n"
+    "#ifdef EAC\n"
+    "    // equi-angular cube faces\n"
+    "    sphericalCoord = vec2(pm_eac_warp(sphericalCoord.x), pm_eac_warp(sphericalCoord.y));\n"
+    "#endif\n"
+    "\n"
+    "    mediump vec3 cartesianCoord = rotation * toCartesian(sphericalCoord);\n"
+    "\n"
+    "    mediump vec2 uv = vec2(pm_erp_u(cartesianCoord.x, cartesianCoord.z), pm_erp_v(cartesianCoord.y));\n"
+    "#ifdef MIPMAP\n"
+    "    // u wraps from 1 to 0 at the seam of the input: there the derivatives of u\n"
+    "    // shifted by half a turn are the right ones, not a jump selecting the smallest level\n"
+    "    mediump vec2 grad_x = dFdx(uv), grad_y = dFdy(uv);\n"
+    "    mediump float shifted = fract(uv.x + 0.5);\n"
+    "    mediump vec2 shifted_grad = vec2(dFdx(shifted), dFdy(shifted));\n"
+    "    if(abs(shifted_grad.x) < abs(grad_x.x))\n"
+    "        grad_x.x = shifted_grad.x;\n"
+    "    if(abs(shifted_grad.y) < abs(grad_y.x))\n"
+    "        grad_y.x = shifted_grad.y;\n"
+    "#endif\n"
+    "\n"
+    "    out_Color = SAMPLE(textureSampler, uv);\n"
+    "#if PLANES > 1\n"
+    "    out_Color1 = SAMPLE(textureSampler1, uv);\n"
+    "#endif\n"
+    "#if PLANES > 2\n"
+    "    out_Color2 = SAMPLE(textureSampler2, uv);\n"
+    "#endif\n"
+    "}\n"
+    ;
+
+static const char shaders_simpleVertex_glsl[] =
+    "#version 330\n"
+    "\n"
+    "layout(location=0) in highp vec4 in_Position;\n"
+    "layout(location=1) in highp vec2 in_uv;\n"
+    "layout(location=2) in highp vec4 in_uvr; // corner coordinates and width and height\n"
+    "\n"
+    "out highp vec2 ex_uv;\n"
+    "flat out highp vec2 corner;\n"
+    "flat out highp vec2 wh;\n"
+    "\n"
+    "const\n"
+    "mat4 view = mat4(\n"
+    "    1.0, 0.0, 0.0, 0.0,\n"
+    "    0.0, 1.0, 0.0, 0.0,\n"
+    "    0.0, 0.0, 1.0, 0.0,\n"
+    "    0.0, 0.0, 0.0, 1.0\n"
+    "    );\n"
+    "void main(void)\n"
+    "{\n"
+    "    gl_Position = in_Position;\n"
+    "\n"
+    "    ex_uv = in_uv;\n"
+    "    wh = in_uvr.zw;\n"
+    "    corner = in_uvr.xy;\n"
+    "    //ex_Color = in_Color;\n"
+    "}\n"
+    ;
+
+static const char shaders_tile_glsl[] =
+    "#version 330\n"
+    "\n"
+    "#define PROJECT_MATH_GLSL\n"
+    "#include \"project_math.h\"\n"
+    "\n"
+    "// how the tiles of the input are sampled, defined by the filter: PM_EQDIS\n"
+    "// (eqdis.glsl), PM_EQDEG (eqdeg.glsl) or PM_UNEQDEG (uneqdeg.glsl)\n"
+    "#ifndef PROJECTION\n"
+    "#define PROJECTION PM_EQDIS\n"
+    "#endif\n"
+    "// the expansion coefficient the input tiles were rendered with\n"
+    "#ifndef ECOEF\n"
+    "#define ECOEF 1.0\n"
+    "#endif\n"
+    "\n"
+    "#ifndef PLANES\n"
+    "#define PLANES 1\n"
+    "#endif\n"
+    "\n"
+    "// 2 for the interleaved chroma plane of semi-planar formats, 4 for packed RGB\n"
+    "#ifndef CHANNELS\n"
+    "#define CHANNELS 1\n"
+    "#endif\n"
+    "#if CHANNELS > 2\n"
+    "#define TEXEL vec4\n"
+    "#define SAMPLE(tex, uv) texture(tex, uv)\n"
+    "#elif CHANNELS > 1\n"
+    "#define TEXEL vec2\n"
+    "#define SAMPLE(tex, uv) texture(tex, uv).rg\n"
+    "#else\n"
+    "#define TEXEL float\n"
+    "#define SAMPLE(tex, uv) texture(tex, uv).r\n"
+    "#endif\n"
+    "\n"
+    "in mediump vec2 ex_uv; // absolute u,v\n"
+    "flat in mediump vec2 wh;\n"
+    "flat in mediump vec2 corner;\n"
+    "\n"
+    "layout(location = 0) out mediump TEXEL out_Color;\n"
+    "#if PLANES > 1\n"
+    "layout(location = 1) out mediump TEXEL out_Color1;\n"
+    "#endif\n"
+    "#if PLANES > 2\n"
+    "layout(location = 2) out mediump TEXEL out_Color2;\n"
+    "#endif\n"
+    "uniform sampler2D textureSampler;\n"
+    "#if PLANES > 1\n"
+    "uniform sampler2D textureSampler1;\n"
+    "#endif\n"
+    "#if PLANES > 2\n"
+    "uniform sampler2D textureSampler2;\n"
+    "#endif\n"
+    "\n"
+    "void main(void)\n"
+    "{\n"
+    "    mediump vec2 uv = vec2(pm_tile_sample(PROJECTION, ex_uv.x, corner.x, wh.x / 2.0, ECOEF),\n"
+    "                           pm_tile_sample(PROJECTION, ex_uv.y, corner.y, wh.y / 2.0, ECOEF));\n"
+    "\n"
+    "    out_Color = SAMPLE(textureSampler, uv);\n"
+    "#if PLANES > 1\n"
+    "    out_Color1 = SAMPLE(textureSampler1, uv);\n"
+    "#endif\n"
+    "#if PLANES > 2\n"
+    "    out_Color2 = SAMPLE(textureSampler2, uv);\n"
+    "#endif\n"
+    "}\n"
+    ;
+
+static const char shaders_toequirectangular_glsl[] =
+    "#version 330\n"
+    "\n"
+    "// Renders an equirectangular frame from the tiles of any input layout. The\n"
+    "// filter defines TILES, the number of tiles, and like for tile.glsl how they\n"
+    "// are sampled (PROJECTION) and their expansion coefficient (ECOEF).\n"
+    "#define PROJECT_MATH_GLSL\n"
+    "#include \"project_math.h\"\n"
+    "\n"
+    "#ifndef PROJECTION\n"
+    "#define PROJECTION PM_EQDIS\n"
+    "#endif\n"
+    "#ifndef ECOEF\n"
+    "#define ECOEF 1.0\n"
+    "#endif\n"
+    "#ifndef TILES\n"
+    "#define TILES 6\n"
+    "#endif\n"
+    "\n"
+    "#ifndef PLANES\n"
+    "#define PLANES 1\n"
+    "#endif\n"
+    "\n"
+    "// 2 for the interleaved chroma plane of semi-planar formats, 4 for packed RGB\n"
+    "#ifndef CHANNELS\n"
+    "#define CHANNELS 1\n"
+    "#endif\n"
+    "// MIPMAP, if defined by the filter, samples with the gradients grad_x and grad_y of main()\n"
+    "#ifdef MIPMAP\n"
+    "#define FETCH(tex, uv) textureGrad(tex, uv, grad_x, grad_y)\n"
+    "#else\n"
+    "#define FETCH(tex, uv) texture(tex, uv)\n"
+    "#endif\n"
+    "#if CHANNELS > 2\n"
+    "#define TEXEL vec4\n"
+    "#define SAMPLE(tex, uv) FETCH(tex, uv)\n"
+    "#elif CHANNELS > 1\n"
+    "#define TEXEL vec2\n"
+    "#define SAMPLE(tex, uv) FETCH(tex, uv).rg\n"
+    "#else\n"
+    "#define TEXEL float\n"
+    "#define SAMPLE(tex, uv) FETCH(tex, uv).r\n"
+    "#endif\n"
+    "\n"
+    "layout(location = 0) out mediump TEXEL out_Color;\n"
+    "#if PLANES > 1\n"
+    "layout(location = 1) out mediump TEXEL out_Color1;\n"
+    "#endif\n"
+    "#if PLANES > 2\n"
+    "layout(location = 2) out mediump TEXEL out_Color2;\n"
+    "#endif\n"
+    "uniform sampler2D textureSampler;\n"
+    "#if PLANES > 1\n"
+    "uniform sampler2D textureSampler1;\n"
+    "#endif\n"
+    "#if PLANES > 2\n"
+    "uniform sampler2D textureSampler2;\n"
+    "#endif\n"
+    "\n"
+    "uniform mediump vec2 resolution;\n"
+    "uniform mediump vec2 origin; // lower left corner of the view in the framebuffer\n"
+    "\n"
+    "// set by the filter for each view\n"
+    "struct Tile {\n"
+    "    mediump vec4 rows[3];   // rotation of a direction of the frame into the space of the tile\n"
+    "    mediump vec4 extent;    // tangents of the half fields of view of the tile\n"
+    "    mediump vec4 rect;      // u, v, w, h of the tile in the input\n"
+    "};\n"
+    "\n"
+    "layout(std140) uniform Tiles {\n"
+    "    Tile tiles[TILES];\n"
+    "};\n"
+    "\n"
+    "// direction d in the space of the tile i\n"
+    "mediump vec3 tileDirection(int i, mediump vec3 d)\n"
+    "{\n"
+    "    return vec3(dot(tiles[i].rows[0].xyz, d), dot(tiles[i].rows[1].xyz, d), dot(tiles[i].rows[2].xyz, d));\n"
+    "}\n"
+    "\n"
+    "// texture coordinates where the direction q, in the space of the tile i, hits it\n"
+    "mediump vec2 tileSample(int i, mediump vec3 q)\n"
+    "{\n"
+    "    mediump vec2 ex = tiles[i].rect.xy + vec2(pm_tile_coord(q.x, q.z, tiles[i].extent.x),\n"
+    "                                              pm_tile_coord(q.y, q.z, tiles[i].extent.y)) * tiles[i].rect.zw;\n"
+    "\n"
+    "    return vec2(pm_tile_sample(PROJECTION, ex.x, tiles[i].rect.x, tiles[i].rect.z / 2.0, ECOEF),\n"
+    "                pm_tile_sample(PROJECTION, ex.y, tiles[i].rect.y, tiles[i].rect.w / 2.0, ECOEF));\n"
+    "}\n"
+    "\n"
+    "void main(void)\n"
+    "{\n"
+    "    mediump vec2 fc = (gl_FragCoord.xy - origin) / resolution;\n"
+    "    mediump vec3 dir = vec3(pm_erp_x(fc.x, fc.y), pm_erp_y(fc.x, fc.y), pm_erp_z(fc.x, fc.y));\n"
+    "#ifdef MIPMAP\n"
+    "    // neighbouring pixels may sample other tiles: the gradients follow the\n"
+    "    // direction, which is continuous, through the tile of this pixel\n"
+    "    mediump vec3 dir_dx = dFdx(dir), dir_dy = dFdy(dir);\n"
+    "#endif\n"
+    "    mediump vec3 q;\n"
+    "    mediump vec2 ab;\n"
+    "    mediump vec2 uv;\n"
+    "    int i;\n"
+    "\n"
+    "    // the tile drawn last covers the others, like when the tiles are rendered as views\n"
+    "    for(i = TILES - 1; i >= 0; i--){\n"
+    "        q = tileDirection(i, dir);\n"
+    "        if(q.z >= 0.0)\n"
+    "            continue;\n"
+    "        ab = vec2(pm_tile_coord(q.x, q.z, tiles[i].extent.x), pm_tile_coord(q.y, q.z, tiles[i].extent.y));\n"
+    "        if(all(greaterThanEqual(ab, vec2(0.0))) && all(lessThanEqual(ab, vec2(1.0))))\n"
+    "            break;\n"
+    "    }\n"
+    "    if(i < 0)\n"
+    "        discard;\n"
+    "\n"
+    "    uv = tileSample(i, q);\n"
+    "#ifdef MIPMAP\n"
+    "    mediump vec2 grad_x = tileSample(i, tileDirection(i, dir + dir_dx)) - uv;\n"
+    "    mediump vec2 grad_y = tileSample(i, tileDirection(i, dir + dir_dy)) - uv;\n"
+    "#endif\n"
+    "\n"
+    "    out_Color = SAMPLE(textureSampler, uv);\n"
+    "#if PLANES > 1\n"
+    "    out_Color1 = SAMPLE(textureSampler1, uv);\n"
+    "#endif\n"
+    "#if PLANES > 2\n"
+    "    out_Color2 = SAMPLE(textureSampler2, uv);\n"
+    "#endif\n"
+    "}\n"
+    ;
+
+static const char shaders_vertex_glsl[] =
+    "#version 330\n"
+    "\n"
+    "layout(location=0) in vec4 in_Position;\n"
+    "layout(location=1) in vec2 in_uv;\n"
+    "layout(location=2) in vec4 in_uvr; // corner coordinates and width and height\n"
+    "\n"
+    "out vec2 ex_uv;\n"
+    "flat out vec2 corner;\n"
+    "flat out vec2 wh;\n"
+    "\n"
+    "uniform mat4 ModelMatrix;\n"
+    "uniform mat4 ViewMatrix;\n"
+    "uniform mat4 ProjectionMatrix;\n"
+    "\n"
+    "const\n"
+    "mat4 view = mat4(\n"
+    "    1.0, 0.0, 0.0, 0.0,\n"
+    "    0.0, 1.0, 0.0, 0.0,\n"
+    "    0.0, 0.0, 1.0, 0.0,\n"
+    "    0.0, 0.0, 0.0, 1.0\n"
+    "    );\n"
+    "void main(void)\n"
+    "{\n"
+    "    gl_Position =  ProjectionMatrix * ModelMatrix * in_Position;\n"
+    "\n"
+    "    ex_uv = in_uv;\n"
+    "    wh = in_uvr.zw;\n"
+    "    corner = in_uvr.xy;\n"
+    "   //ex_Color = in_Color;\n"
+    "}\n"
+    ;
+
+static const char shaders_project_math_h[] =
+    "#ifndef _M_PROJECT_MATH_H\n"
+    "#define _M_PROJECT_MATH_H\n"
+    "\n"
+    "/*\n"
+    " * Projection math shared by the shaders and the cpu backend. The functions are\n"
+    " * written in the common subset of C and GLSL: scalar arguments and results,\n"
+    " * float literals, and the macros below for what differs. embed.pl inlines this\n"
+    " * file where a built-in shader has #include \"project_math.h\"; a shader defines\n"
+    " * PROJECT_MATH_GLSL before including it.\n"
+    " *\n"
+    " * Conventions: a tile is the view rendered with a rotation and a field of view,\n"
+    " * looking down -z of its space, with -y towards the first row of its pixels. Its\n"
+    " * point (a, b) in [0,1]^2 is at ((2a-1) tan(fovx/2), (2b-1) tan(fovy/2), -1).\n"
+    " * An equirectangular frame maps the direction (x, y, z) to longitude\n"
+    " * atan2(x, z) and colatitude acos(y), both normalized to [0,1].\n"
+    " */\n"
+    "\n"
+    "#ifdef PROJECT_MATH_GLSL\n"
+    "#define PM_FUNC\n"
+    "#define PM_FLOAT float\n"
+    "#define PM_ATAN2(y, x) atan(y, x)\n"
+    "#define PM_CLAMP(x, lo, hi) clamp(x, lo, hi)\n"
+    "#else\n"
+    "#include <math.h>\n"
+    "#define PM_FUNC static inline\n"
+    "#define PM_FLOAT double\n"
+    "#define PM_ATAN2(y, x) atan2(y, x)\n"
+    "#define PM_CLAMP(x, lo, hi) fmin(fmax(x, lo), hi)\n"
+    "#endif\n"
+    "\n"
+    "#define PM_PI 3.14159265358979323846\n"
+    "#define PM_PI_4 0.785398163397448309616\n"
+    "\n"
+    "// how the tiles of the input are sampled, the PROJECTION of tile.glsl\n"
+    "#define PM_EQDIS 0      // linearly\n"
+    "#define PM_EQDEG 1      // through tan()\n"
+    "#define PM_UNEQDEG 2    // through atan()\n"
+    "\n"
+    "PM_FUNC PM_FLOAT pm_radians(PM_FLOAT degrees)\n"
+    "{\n"
+    "    return degrees * (PM_PI / 180.0);\n"
+    "}\n"
+    "\n"
+    "// Half extent of a tile at distance 1\n"
+    "PM_FUNC PM_FLOAT pm_tile_extent(PM_FLOAT fov_degrees)\n"
+    "{\n"
+    "    return tan(pm_radians(fov_degrees / 2.0));\n"
+    "}\n"
+    "\n"
+    "// Coordinate in [0,1] of a tile of the given extent where the direction (q, qz) in its space hits it, qz < 0\n"
+    "PM_FUNC PM_FLOAT pm_tile_coord(PM_FLOAT q, PM_FLOAT qz, PM_FLOAT extent)\n"
+    "{\n"
+    "    return (q / (-qz * extent) + 1.0) / 2.0;\n"
+    "}\n"
+    "\n"
+    "// Inverse of pm_tile_coord(): the point of the tile at distance 1\n"
+    "PM_FUNC PM_FLOAT pm_tile_point(PM_FLOAT a, PM_FLOAT extent)\n"
+    "{\n"
+    "    return (2.0 * a - 1.0) * extent;\n"
+    "}\n"
+    "\n"
+    "/*\n"
+    " * Texture coordinate sampled at the point ex of a tile starting at corner with\n"
+    " * half size hsize, for the sampling and the expansion coefficient the tile was\n"
+    " * rendered with. (half is a reserved word in GLSL.)\n"
+    " */\n"
+    "PM_FUNC PM_FLOAT pm_tile_sample(int sampling, PM_FLOAT ex, PM_FLOAT corner, PM_FLOAT hsize, PM_FLOAT ecoef)\n"
+    "{\n"
+    "    PM_FLOAT ratio;\n"
+    "\n"
+    "    if(sampling == PM_EQDEG){\n"
+    "        ratio = (ex - corner - hsize) / hsize / ecoef;\n"
+    "        return corner + tan(ratio * PM_PI_4) * hsize + hsize;\n"
+    "    }\n"
+    "    if(sampling == PM_UNEQDEG){\n"
+    "        ratio = PM_ATAN2((ex - corner - hsize) / ecoef, hsize) / PM_PI_4;\n"
+    "        return corner + hsize + ratio * hsize;\n"
+    "    }\n"
+    "    if(ecoef == 1.0)\n"
+    "        return ex;\n"
+    "    return corner + (hsize + (ex - corner - hsize) / ecoef);\n"
+    "}\n"
+    "\n"
+    "// Position in [-0.5,0.5] on an equi-angular cube face of the position s on a standard one\n"
+    "PM_FUNC PM_FLOAT pm_eac_warp(PM_FLOAT s)\n"
+    "{\n"
+    "    return tan(s * PM_PI / 2.0) / 2.0;\n"
+    "}\n"
+    "\n"
+    "// Equirectangular coordinates of the unit direction (x, y, z)\n"
+    "PM_FUNC PM_FLOAT pm_erp_u(PM_FLOAT x, PM_FLOAT z)\n"
+    "{\n"
+    "    PM_FLOAT lon = PM_ATAN2(x, z);\n"
+    "\n"
+    "    if(lon < 0.0)\n"
+    "        lon += 2.0 * PM_PI;\n"
+    "    return lon / (2.0 * PM_PI);\n"
+    "}\n"
+    "\n"
+    "PM_FUNC PM_FLOAT pm_erp_v(PM_FLOAT y)\n"
+    "{\n"
+    "    return acos(PM_CLAMP(y, -1.0, 1.0)) / PM_PI;\n"
+    "}\n"
+    "\n"
+    "// Unit direction at the equirectangular coordinates (u, v), the inverse of pm_erp_u() and pm_erp_v()\n"
+    "PM_FUNC PM_FLOAT pm_erp_x(PM_FLOAT u, PM_FLOAT v)\n"
+    "{\n"
+    "    return sin(v * PM_PI) * sin(u * 2.0 * PM_PI);\n"
+    "}\n"
+    "\n"
+    "PM_FUNC PM_FLOAT pm_erp_y(PM_FLOAT u, PM_FLOAT v)\n"
+    "{\n"
+    "    return cos(v * PM_PI);\n"
+    "}\n"
+    "\n"
+    "PM_FUNC PM_FLOAT pm_erp_z(PM_FLOAT u, PM_FLOAT v)\n"
+    "{\n"
+    "    return sin(v * PM_PI) * cos(u * 2.0 * PM_PI);\n"
+    "}\n"
+    "\n"
+    "#endif\n"
+    ;
+
+const EmbeddedFile ff_project_shaders[] = {
+    { "equirectangular.glsl", shaders_equirectangular_glsl },
+    { "simpleVertex.glsl", shaders_simpleVertex_glsl },
+    { "tile.glsl", shaders_tile_glsl },
+    { "toequirectangular.glsl", shaders_toequirectangular_glsl },
+    { "vertex.glsl", shaders_vertex_glsl },
+    { "project_math.h", shaders_project_math_h },
+    { NULL, NULL },
+};
+
+static const char layouts_baseball_lt[] =
+    "0.333333:0.5:90:90:0:0:0:0.333333:0\n"
+    "0.333333:0.5:90:90:0:90:0:0.666667:0\n"
+    "0.333333:0.5:90:90:0:-90:0:0:0\n"
+    "0.333333:0.5:90:90:90:-90:0:0.666667:0.5\n"
+    "0.333333:0.5:90:90:-90:90:0:0:0.5\n"
+    "0.333333:0.5:90:90:180:0:90:0.333333:0.5\n"
+    ;
+
+static const char layouts_cube_lt[] =
+    "0.333333:0.5:90:90:0:0:0:0.333333:0.5\n"
+    "0.333333:0.5:90:90:90:0:0:0.666667:0\n"
+    "0.333333:0.5:90:90:-90:0:0:0:0.5\n"
+    "0.333333:0.5:90:90:0:90:0:0:0\n"
+    "0.333333:0.5:90:90:0:-90:0:0.333333:0\n"
+    "0.333333:0.5:90:90:0:180:0:0.666667:0.5\n"
+    ;
+
+static const char layouts_equirectangular_lt[] =
+    "1:1:90:90:0:0:0:1:1\n"
+    ;
+
+static const char layouts_example_lt[] =
+    "1800:1200\n"
+    "600:600:90:0:90:0:eqdis:0:0\n"
+    "600:600:90:0:270:0:eqdis:600:0\n"
+    "600:600:90:90:0:0:eqdis:1200:0\n"
+    "600:600:90:-90:0:0:eqdis:0:600\n"
+    "600:600:90:0:0:0:eqdis:600:600\n"
+    "600:600:90:0:180:0:eqdis:1200:600\n"
+    ;
+
+static const char layouts_good_lt[] =
+    "2240:832\n"
+    "120:120:20:59:0.000000:0:eqdis:0:0\n"
+    "120:120:20:59:30.000000:0:eqdis:120:0\n"
+    "120:120:20:59:60.000000:0:eqdis:240:0\n"
+    "120:120:20:59:90.000000:0:eqdis:360:0\n"
+    "120:120:20:59:120.000000:0:eqdis:480:0\n"
+    "120:120:20:59:150.000000:0:eqdis:600:0\n"
+    "120:120:20:59:180.000000:0:eqdis:720:0\n"
+    "120:120:20:59:210.000000:0:eqdis:840:0\n"
+    "120:120:20:59:240.000000:0:eqdis:960:0\n"
+    "120:120:20:59:270.000000:0:eqdis:1080:0\n"
+    "120:120:20:59:300.000000:0:eqdis:1200:0\n"
+    "120:120:20:59:330.000000:0:eqdis:1320:0\n"
+    "152:152:26:37:0.000000:0:eqdis:0:120\n"
+    "152:152:26:37:27.692308:0:eqdis:152:120\n"
+    "152:152:26:37:55.384615:0:eqdis:304:120\n"
+    "152:152:26:37:83.076923:0:eqdis:456:120\n"
+    "152:152:26:37:110.769231:0:eqdis:608:120\n"
+    "152:152:26:37:138.461538:0:eqdis:760:120\n"
+    "152:152:26:37:166.153846:0:eqdis:912:120\n"
+    "152:152:26:37:193.846154:0:eqdis:1064:120\n"
+    "152:152:26:37:221.538462:0:eqdis:1216:120\n"
+    "152:152:26:37:249.230769:0:eqdis:1368:120\n"
+    "152:152:26:37:276.923077:0:eqdis:1520:120\n"
+    "152:152:26:37:304.615385:0:eqdis:1672:120\n"
+    "152:152:26:37:332.307692:0:eqdis:1824:120\n"
+    "144:144:25:12:0.000000:0:eqdis:0:272\n"
+    "144:144:25:12:24.000000:0:eqdis:144:272\n"
+    "144:144:25:12:48.000000:0:eqdis:288:272\n"
+    "144:144:25:12:72.000000:0:eqdis:432:272\n"
+    "144:144:25:12:96.000000:0:eqdis:576:272\n"
+    "144:144:25:12:120.000000:0:eqdis:720:272\n"
+    "144:144:25:12:144.000000:0:eqdis:864:272\n"
+    "144:144:25:12:168.000000:0:eqdis:1008:272\n"
+    "144:144:25:12:192.000000:0:eqdis:1152:272\n"
+    "144:144:25:12:216.000000:0:eqdis:1296:272\n"
+    "144:144:25:12:240.000000:0:eqdis:1440:272\n"
+    "144:144:25:12:264.000000:0:eqdis:1584:272\n"
+    "144:144:25:12:288.000000:0:eqdis:1728:272\n"
+    "144:144:25:12:312.000000:0:eqdis:1872:272\n"
+    "144:144:25:12:336.000000:0:eqdis:2016:272\n"
+    "144:144:25:-12:0.000000:0:eqdis:0:416\n"
+    "144:144:25:-12:24.000000:0:eqdis:144:416\n"
+    "144:144:25:-12:48.000000:0:eqdis:288:416\n"
+    "144:144:25:-12:72.000000:0:eqdis:432:416\n"
+    "144:144:25:-12:96.000000:0:eqdis:576:416\n"
+    "144:144:25:-12:120.000000:0:eqdis:720:416\n"
+    "144:144:25:-12:144.000000:0:eqdis:864:416\n"
+    "144:144:25:-12:168.000000:0:eqdis:1008:416\n"
+    "144:144:25:-12:192.000000:0:eqdis:1152:416\n"
+    "144:144:25:-12:216.000000:0:eqdis:1296:416\n"
+    "144:144:25:-12:240.000000:0:eqdis:1440:416\n"
+    "144:144:25:-12:264.000000:0:eqdis:1584:416\n"
+    "144:144:25:-12:288.000000:0:eqdis:1728:416\n"
+    "144:144:25:-12:312.000000:0:eqdis:1872:416\n"
+    "144:144:25:-12:336.000000:0:eqdis:2016:416\n"
+    "152:152:26:-37:0.000000:0:eqdis:0:560\n"
+    "152:152:26:-37:27.692308:0:eqdis:152:560\n"
+    "152:152:26:-37:55.384615:0:eqdis:304:560\n"
+    "152:152:26:-37:83.076923:0:eqdis:456:560\n"
+    "152:152:26:-37:110.769231:0:eqdis:608:560\n"
+    "152:152:26:-37:138.461538:0:eqdis:760:560\n"
+    "152:152:26:-37:166.153846:0:eqdis:912:560\n"
+    "152:152:26:-37:193.846154:0:eqdis:1064:560\n"
+    "152:152:26:-37:221.538462:0:eqdis:1216:560\n"
+    "152:152:26:-37:249.230769:0:eqdis:1368:560\n"
+    "152:152:26:-37:276.923077:0:eqdis:1520:560\n"
+    "152:152:26:-37:304.615385:0:eqdis:1672:560\n"
+    "152:152:26:-37:332.307692:0:eqdis:1824:560\n"
+    "120:120:20:-59:0.000000:0:eqdis:0:712\n"
+    "120:120:20:-59:30.000000:0:eqdis:120:712\n"
+    "120:120:20:-59:60.000000:0:eqdis:240:712\n"
+    "120:120:20:-59:90.000000:0:eqdis:360:712\n"
+    "120:120:20:-59:120.000000:0:eqdis:480:712\n"
+    "120:120:20:-59:150.000000:0:eqdis:600:712\n"
+    "120:120:20:-59:180.000000:0:eqdis:720:712\n"
+    "120:120:20:-59:210.000000:0:eqdis:840:712\n"
+    "120:120:20:-59:240.000000:0:eqdis:960:712\n"
+    "120:120:20:-59:270.000000:0:eqdis:1080:712\n"
+    "120:120:20:-59:300.000000:0:eqdis:1200:712\n"
+    "120:120:20:-59:330.000000:0:uneqdeg:1320:712\n"
+    "264:264:44:90:0.000000:0:eqdis:1976:0\n"
+    "264:264:44:-90:0.000000:0:eqdeg:1976:568\n"
+    ;
+
+static const char layouts_good_normal_lt[] =
+    "0.0535714285714286:0.144230769230769:20:20:59:0.000000:0:0:0\n"
+    "0.0535714285714286:0.144230769230769:20:20:59:30.000000:0:0.0535714285714286:0\n"
+    "0.0535714285714286:0.144230769230769:20:20:59:60.000000:0:0.107142857142857:0\n"
+    "0.0535714285714286:0.144230769230769:20:20:59:90.000000:0:0.160714285714286:0\n"
+    "0.0535714285714286:0.144230769230769:20:20:59:120.000000:0:0.214285714285714:0\n"
+    "0.0535714285714286:0.144230769230769:20:20:59:150.000000:0:0.267857142857143:0\n"
+    "0.0535714285714286:0.144230769230769:20:20:59:180.000000:0:0.321428571428571:0\n"
+    "0.0535714285714286:0.144230769230769:20:20:59:210.000000:0:0.375:0\n"
+    "0.0535714285714286:0.144230769230769:20:20:59:240.000000:0:0.428571428571429:0\n"
+    "0.0535714285714286:0.144230769230769:20:20:59:270.000000:0:0.482142857142857:0\n"
+    "0.0535714285714286:0.144230769230769:20:20:59:300.000000:0:0.535714285714286:0\n"
+    "0.0535714285714286:0.144230769230769:20:20:59:330.000000:0:0.589285714285714:0\n"
+    "0.0678571428571429:0.182692307692308:26:26:37:0.000000:0:0:0.144230769230769\n"
+    "0.0678571428571429:0.182692307692308:26:26:37:27.692308:0:0.0678571428571429:0.144230769230769\n"
+    "0.0678571428571429:0.182692307692308:26:26:37:55.384615:0:0.135714285714286:0.144230769230769\n"
+    "0.0678571428571429:0.182692307692308:26:26:37:83.076923:0:0.203571428571429:0.144230769230769\n"
+    "0.0678571428571429:0.182692307692308:26:26:37:110.769231:0:0.271428571428571:0.144230769230769\n"
+    "0.0678571428571429:0.182692307692308:26:26:37:138.461538:0:0.339285714285714:0.144230769230769\n"
+    "0.0678571428571429:0.182692307692308:26:26:37:166.153846:0:0.407142857142857:0.144230769230769\n"
+    "0.0678571428571429:0.182692307692308:26:26:37:193.846154:0:0.475:0.144230769230769\n"
+    "0.0678571428571429:0.182692307692308:26:26:37:221.538462:0:0.542857142857143:0.144230769230769\n"
+    "0.0678571428571429:0.182692307692308:26:26:37:249.230769:0:0.610714285714286:0.144230769230769\n"
+    "0.0678571428571429:0.182692307692308:26:26:37:276.923077:0:0.678571428571429:0.144230769230769\n"
+    "0.0678571428571429:0.182692307692308:26:26:37:304.615385:0:0.746428571428571:0.144230769230769\n"
+    "0.0678571428571429:0.182692307692308:26:26:37:332.307692:0:0.814285714285714:0.144230769230769\n"
+    "0.0642857142857143:0.173076923076923:25:25:12:0.000000:0:0:0.326923076923077\n"
+    "0.0642857142857143:0.173076923076923:25:25:12:24.000000:0:0.0642857142857143:0.326923076923077\n"
+    "0.0642857142857143:0.173076923076923:25:25:12:48.000000:0:0.128571428571429:0.326923076923077\n"
+    "0.0642857142857143:0.173076923076923:25:25:12:72.000000:0:0.192857142857143:0.326923076923077\n"
+    "0.0642857142857143:0.173076923076923:25:25:12:96.000000:0:0.257142857142857:0.326923076923077\n"
+    "0.0642857142857143:0.173076923076923:25:25:12:120.000000:0:0.321428571428571:0.326923076923077\n"
+    "0.0642857142857143:0.173076923076923:25:25:12:144.000000:0:0.385714285714286:0.326923076923077\n"
+    "0.0642857142857143:0.173076923076923:25:25:12:168.000000:0:0.45:0.326923076923077\n"
+    "0.0642857142857143:0.173076923076923:25:25:12:192.000000:0:0.514285714285714:0.326923076923077\n"
+    "0.0642857142857143:0.173076923076923:25:25:12:216.000000:0:0.578571428571429:0.326923076923077\n"
+    "0.0642857142857143:0.173076923076923:25:25:12:240.000000:0:0.642857142857143:0.326923076923077\n"
+    "0.0642857142857143:0.173076923076923:25:25:12:264.000000:0:0.707142857142857:0.326923076923077\n"
+    "0.0642857142857143:0.173076923076923:25:25:12:288.000000:0:0.771428571428571:0.326923076923077\n"
+    "0.0642857142857143:0.173076923076923:25:25:12:312.000000:0:0.835714285714286:0.326923076923077\n"
+    "0.0642857142857143:0.173076923076923:25:25:12:336.000000:0:0.9:0.326923076923077\n"
+    "0.0642857142857143:0.173076923076923:25:25:-12:0.000000:0:0:0.5\n"
+    "0.0642857142857143:0.173076923076923:25:25:-12:24.000000:0:0.0642857142857143:0.5\n"
+    "0.0642857142857143:0.173076923076923:25:25:-12:48.000000:0:0.128571428571429:0.5\n"
+    "0.0642857142857143:0.173076923076923:25:25:-12:72.000000:0:0.192857142857143:0.5\n"
+    "0.0642857142857143:0.173076923076923:25:25:-12:96.000000:0:0.257142857142857:0.5\n"
+    "0.0642857142857143:0.173076923076923:25:25:-12:120.000000:0:0.321428571428571:0.5\n"
+    "0.0642857142857143:0.173076923076923:25:25:-12:144.000000:0:0.385714285714286:0.5\n"
+    "0.0642857142857143:0.173076923076923:25:25:-12:168.000000:0:0.45:0.5\n"
+    "0.0642857142857143:0.173076923076923:25:25:-12:192.000000:0:0.514285714285714:0.5\n"
+    "0.0642857142857143:0.173076923076923:25:25:-12:216.000000:0:0.578571428571429:0.5\n"
+    "0.0642857142857143:0.173076923076923:25:25:-12:240.000000:0:0.642857142857143:0.5\n"
+    "0.0642857142857143:0.173076923076923:25:25:-12:264.000000:0:0.707142857142857:0.5\n"
+    "0.0642857142857143:0.173076923076923:25:25:-12:288.000000:0:0.771428571428571:0.5\n"
+    "0.0642857142857143:0.173076923076923:25:25:-12:312.000000:0:0.835714285714286:0.5\n"
+    "0.0642857142857143:0.173076923076923:25:25:-12:336.000000:0:0.9:0.5\n"
+    "0.0678571428571429:0.182692307692308:26:26:-37:0.000000:0:0:0.673076923076923\n"
+    "0.0678571428571429:0.182692307692308:26:26:-37:27.692308:0:0.0678571428571429:0.673076923076923\n"
+    "0.0678571428571429:0.182692307692308:26:26:-37:55.384615:0:0.135714285714286:0.673076923076923\n"
+    "0.0678571428571429:0.182692307692308:26:26:-37:83.076923:0:0.203571428571429:0.673076923076923\n"
+    "0.0678571428571429:0.182692307692308:26:26:-37:110.769231:0:0.271428571428571:0.673076923076923\n"
+    "0.0678571428571429:0.182692307692308:26:26:-37:138.461538:0:0.339285714285714:0.673076923076923\n"
+    "0.0678571428571429:0.182692307692308:26:26:-37:166.153846:0:0.407142857142857:0.673076923076923\n"
+    "0.0678571428571429:0.182692307692308:26:26:-37:193.846154:0:0.475:0.673076923076923\n"
+    "0.0678571428571429:0.182692307692308:26:26:-37:221.538462:0:0.542857142857143:0.673076923076923\n"
+    "0.0678571428571429:0.182692307692308:26:26:-37:249.230769:0:0.610714285714286:0.673076923076923\n"
+    "0.0678571428571429:0.182692307692308:26:26:-37:276.923077:0:0.678571428571429:0.673076923076923\n"
+    "0.0678571428571429:0.182692307692308:26:26:-37:304.615385:0:0.746428571428571:0.673076923076923\n"
+    "0.0678571428571429:0.182692307692308:26:26:-37:332.307692:0:0.814285714285714:0.673076923076923\n"
+    "0.0535714285714286:0.144230769230769:20:20:-59:0.000000:0:0:0.855769230769231\n"
+    "0.0535714285714286:0.144230769230769:20:20:-59:30.000000:0:0.0535714285714286:0.855769230769231\n"
+    "0.0535714285714286:0.144230769230769:20:20:-59:60.000000:0:0.107142857142857:0.855769230769231\n"
+    "0.0535714285714286:0.144230769230769:20:20:-59:90.000000:0:0.160714285714286:0.855769230769231\n"
+    "0.0535714285714286:0.144230769230769:20:20:-59:120.000000:0:0.214285714285714:0.855769230769231\n"
+    "0.0535714285714286:0.144230769230769:20:20:-59:150.000000:0:0.267857142857143:0.855769230769231\n"
+    "0.0535714285714286:0.144230769230769:20:20:-59:180.000000:0:0.321428571428571:0.855769230769231\n"
+    "0.0535714285714286:0.144230769230769:20:20:-59:210.000000:0:0.375:0.855769230769231\n"
+    "0.0535714285714286:0.144230769230769:20:20:-59:240.000000:0:0.428571428571429:0.855769230769231\n"
+    "0.0535714285714286:0.144230769230769:20:20:-59:270.000000:0:0.482142857142857:0.855769230769231\n"
+    "0.0535714285714286:0.144230769230769:20:20:-59:300.000000:0:0.535714285714286:0.855769230769231\n"
+    "0.0535714285714286:0.144230769230769:20:20:-59:330.000000:0:0.589285714285714:0.855769230769231\n"
+    "0.117857142857143:0.317307692307692:44:44:90:0.000000:0:0.882142857142857:0\n"
+    "0.117857142857143:0.317307692307692:44:44:-90:0.000000:0:0.882142857142857:0.682692307692308\n"
+    ;
+
+static const char layouts_rotated_cube_lt[] =
+    "0.333333:0.5:90:90:12:0:0:0.333333:0.5\n"
+    "0.333333:0.5:90:90:102:0:0:0.666667:0\n"
+    "0.333333:0.5:90:90:-78:0:0:0:0.5\n"
+    "0.333333:0.5:90:90:0:90:-12:0:0\n"
+    "0.333333:0.5:90:90:0:-90:12:0.333333:0\n"
+    "0.333333:0.5:90:90:-12:-180:0:0.666667:0.5\n"
+    ;
+
+static const char layouts_vcube_lt[] =
+    "0.5:0.333333:90:90:90:0:90:0:0\n"
+    "0.5:0.333333:90:90:0:0:90:0:0.333333\n"
+    "0.5:0.333333:90:90:-90:0:90:0:0.666667\n"
+    "0.5:0.333333:90:90:90:180:0:0.5:0\n"
+    "0.5:0.333333:90:90:0:180:0:0.5:0.333333\n"
+    "0.5:0.333333:90:90:-90:180:0:0.5:0.666667\n"
+    ;
+
+const EmbeddedFile ff_project_layouts[] = {
+    { "baseball.lt", layouts_baseball_lt },
+    { "cube.lt", layouts_cube_lt },
+    { "equirectangular.lt", layouts_equirectangular_lt },
+    { "example.lt", layouts_example_lt },
+    { "good.lt", layouts_good_lt },
+    { "good_normal.lt", layouts_good_normal_lt },
+    { "rotated_cube.lt", layouts_rotated_cube_lt },
+    { "vcube.lt", layouts_vcube_lt },
+    { NULL, NULL },
+};
+
@@ -0,0 +1,17 @@
+#ifndef _M_PROJECT_EMBEDDED_H
+#define _M_PROJECT_EMBEDDED_H
+
+/*
+ * Shaders and layouts compiled into the filter, see embed.pl. Both tables end
+ * with a NULL name; a file not found in them is read from ffmpeg360_shader/
+ * or ffmpeg360_layout/ in the working directory.
+ */
+typedef struct EmbeddedFile {
+    const char *name;
+    const char *data;
+} EmbeddedFile;
+
+extern const EmbeddedFile ff_project_shaders[];
+extern const EmbeddedFile ff_project_layouts[];
+
+#endif
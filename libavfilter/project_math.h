@@ -0,0 +1,121 @@
+#ifndef _M_PROJECT_MATH_H
+#define _M_PROJECT_MATH_H
+
+/*
+ * Projection math shared by the shaders and the cpu backend. The functions are
+ * written in the common subset of C and GLSL: scalar arguments and results,
+ * float literals, and the macros below for what differs. embed.pl inlines this
+ * file where a built-in shader has #include "project_math.h"; a shader defines
+ * PROJECT_MATH_GLSL before including it.
+ *
+ * Conventions: a tile is the view rendered with a rotation and a field of view,
+ * looking down -z of its space, with -y towards the first row of its pixels. Its
+ * point (a, b) in [0,1]^2 is at ((2a-1) tan(fovx/2), (2b-1) tan(fovy/2), -1).
+ * An equirectangular frame maps the direction (x, y, z) to longitude
+ * atan2(x, z) and colatitude acos(y), both normalized to [0,1].
+ */
+
+#ifdef PROJECT_MATH_GLSL
+#define PM_FUNC
+#define PM_FLOAT float
+#define PM_ATAN2(y, x) atan(y, x)
+#define PM_CLAMP(x, lo, hi) clamp(x, lo, hi)
+#else
+#include <math.h>
+#define PM_FUNC static inline
+#define PM_FLOAT double
+#define PM_ATAN2(y, x) atan2(y, x)
+#define PM_CLAMP(x, lo, hi) fmin(fmax(x, lo), hi)
+#endif
+
+#define PM_PI 3.14159265358979323846
+#define PM_PI_4 0.785398163397448309616
+
+// how the tiles of the input are sampled, the PROJECTION of tile.glsl
+#define PM_EQDIS 0      // linearly
+#define PM_EQDEG 1      // through tan()
+#define PM_UNEQDEG 2    // through atan()
+
+PM_FUNC PM_FLOAT pm_radians(PM_FLOAT degrees)
+{
+    return degrees * (PM_PI / 180.0);
+}
+
+// Half extent of a tile at distance 1
+PM_FUNC PM_FLOAT pm_tile_extent(PM_FLOAT fov_degrees)
+{
+    return tan(pm_radians(fov_degrees / 2.0));
+}
+
+// Coordinate in [0,1] of a tile of the given extent where the direction (q, qz) in its space hits it, qz < 0
+PM_FUNC PM_FLOAT pm_tile_coord(PM_FLOAT q, PM_FLOAT qz, PM_FLOAT extent)
+{
+    return (q / (-qz * extent) + 1.0) / 2.0;
+}
+
+// Inverse of pm_tile_coord(): the point of the tile at distance 1
+PM_FUNC PM_FLOAT pm_tile_point(PM_FLOAT a, PM_FLOAT extent)
+{
+    return (2.0 * a - 1.0) * extent;
+}
+
+/*
+ * Texture coordinate sampled at the point ex of a tile starting at corner with
+ * half size hsize, for the sampling and the expansion coefficient the tile was
+ * rendered with. (half is a reserved word in GLSL.)
+ */
+PM_FUNC PM_FLOAT pm_tile_sample(int sampling, PM_FLOAT ex, PM_FLOAT corner, PM_FLOAT hsize, PM_FLOAT ecoef)
+{
+    PM_FLOAT ratio;
+
+    if(sampling == PM_EQDEG){
+        ratio = (ex - corner - hsize) / hsize / ecoef;
+        return corner + tan(ratio * PM_PI_4) * hsize + hsize;
+    }
+    if(sampling == PM_UNEQDEG){
+        ratio = PM_ATAN2((ex - corner - hsize) / ecoef, hsize) / PM_PI_4;
+        return corner + hsize + ratio * hsize;
+    }
+    if(ecoef == 1.0)
+        return ex;
+    return corner + (hsize + (ex - corner - hsize) / ecoef);
+}
+
+// Position in [-0.5,0.5] on an equi-angular cube face of the position s on a standard one
+PM_FUNC PM_FLOAT pm_eac_warp(PM_FLOAT s)
+{
+    return tan(s * PM_PI / 2.0) / 2.0;
+}
+
+// Equirectangular coordinates of the unit direction (x, y, z)
+PM_FUNC PM_FLOAT pm_erp_u(PM_FLOAT x, PM_FLOAT z)
+{
+    PM_FLOAT lon = PM_ATAN2(x, z);
+
+    if(lon < 0.0)
+        lon += 2.0 * PM_PI;
+    return lon / (2.0 * PM_PI);
+}
+
+PM_FUNC PM_FLOAT pm_erp_v(PM_FLOAT y)
+{
+    return acos(PM_CLAMP(y, -1.0, 1.0)) / PM_PI;
+}
+
+// Unit direction at the equirectangular coordinates (u, v), the inverse of pm_erp_u() and pm_erp_v()
+PM_FUNC PM_FLOAT pm_erp_x(PM_FLOAT u, PM_FLOAT v)
+{
+    return sin(v * PM_PI) * sin(u * 2.0 * PM_PI);
+}
+
+PM_FUNC PM_FLOAT pm_erp_y(PM_FLOAT u, PM_FLOAT v)
+{
+    return cos(v * PM_PI);
+}
+
+PM_FUNC PM_FLOAT pm_erp_z(PM_FLOAT u, PM_FLOAT v)
+{
+    return sin(v * PM_PI) * cos(u * 2.0 * PM_PI);
+}
+
+#endif
@@ -0,0 +1,67 @@
+#include "config.h"
+#include "libavutil/attributes.h"
+#include "libavutil/common.h"
+#include "project_remap.h"
+
+void ff_project_remap_line_c(uint8_t *dst, const uint8_t *src, ptrdiff_t linesize,
+                             const float *lut, int w, int src_w, int src_h)
+{
+    const int max_x = src_w - 2, max_y = src_h - 2;
+    const uint8_t *p;
+    float fx, fy, top, bottom;
+    int i, x0, y0;
+
+    for(i = 0; i < w; i++, lut += 2){
+        if(lut[0] < 0){
+            dst[i] = 0;
+            continue;
+        }
+
+        // the right and bottom edge interpolate towards the last texel with a weight of 1
+        x0 = FFMIN((int)lut[0], max_x);
+        y0 = FFMIN((int)lut[1], max_y);
+        fx = lut[0] - x0;
+        fy = lut[1] - y0;
+
+        p = src + y0 * linesize + x0;
+        top = p[0] + fx * (p[1] - p[0]);
+        bottom = p[linesize] + fx * (p[linesize + 1] - p[linesize]);
+        dst[i] = top + fy * (bottom - top) + 0.5f;
+    }
+}
+
+void ff_project_remap_line_fixed_c(uint8_t *dst, const uint8_t *src, ptrdiff_t linesize,
+                                   const uint16_t *lut, int w, int src_w, int src_h)
+{
+    const int max_x = src_w - 2, max_y = src_h - 2;
+    const uint8_t *p;
+    int i, x0, y0, fx, fy, top, bottom;
+
+    for(i = 0; i < w; i++, lut += 2){
+        if(lut[0] == PROJECT_REMAP_UNCOVERED){
+            dst[i] = 0;
+            continue;
+        }
+
+        x0 = FFMIN(lut[0] >> PROJECT_REMAP_FRAC_BITS, max_x);
+        y0 = FFMIN(lut[1] >> PROJECT_REMAP_FRAC_BITS, max_y);
+        fx = lut[0] - (x0 << PROJECT_REMAP_FRAC_BITS);
+        fy = lut[1] - (y0 << PROJECT_REMAP_FRAC_BITS);
+
+        p = src + y0 * linesize + x0;
+        top = p[0] * (PROJECT_REMAP_ONE - fx) + p[1] * fx;
+        bottom = p[linesize] * (PROJECT_REMAP_ONE - fx) + p[linesize + 1] * fx;
+        dst[i] = (top * (PROJECT_REMAP_ONE - fy) + bottom * fy + (1 << (2 * PROJECT_REMAP_FRAC_BITS - 1))) >> (2 * PROJECT_REMAP_FRAC_BITS);
+    }
+}
+
+av_cold void ff_project_remap_init(ProjectRemapContext *r)
+{
+    r->remap_line = ff_project_remap_line_c;
+    r->remap_line_padded = ff_project_remap_line_c;
+    r->remap_line_fixed = ff_project_remap_line_fixed_c;
+    r->remap_line_fixed_padded = ff_project_remap_line_fixed_c;
+
+    if(ARCH_X86)
+        ff_project_remap_init_x86(r);
+}
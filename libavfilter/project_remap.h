@@ -0,0 +1,54 @@
+#ifndef _M_PROJECT_REMAP_H
+#define _M_PROJECT_REMAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// bytes past the end of a source row that remap_line_padded() may read
+#define PROJECT_REMAP_PADDING 2
+
+// fixed-point tables: 12.4 texel coordinates, planes up to 4096x4096
+#define PROJECT_REMAP_FRAC_BITS 4
+#define PROJECT_REMAP_ONE (1 << PROJECT_REMAP_FRAC_BITS)
+#define PROJECT_REMAP_FIXED_MAX 4096
+#define PROJECT_REMAP_UNCOVERED 0xffff
+
+/**
+ * Sample one output line of a plane from the source plane, bilinearly and
+ * clamped to the edges like the GL textures.
+ *
+ * @param lut texel coordinates x, y of each output pixel in the source,
+ *            clamped to [0, src_w - 1] x [0, src_h - 1]; x < 0 marks a pixel
+ *            no tile covers, which is set to 0
+ * @param src_w, src_h size of the source plane, at least 2x2
+ */
+typedef void (*project_remap_line_fn)(uint8_t *dst, const uint8_t *src, ptrdiff_t linesize,
+                                      const float *lut, int w, int src_w, int src_h);
+
+/**
+ * Same as project_remap_line_fn with fixed-point coordinates, a quarter of the
+ * size of the float ones per plane and pixel.
+ *
+ * @param lut 12.4 texel coordinates x, y of each output pixel, clamped like
+ *            the float ones; x == PROJECT_REMAP_UNCOVERED marks a pixel no
+ *            tile covers
+ */
+typedef void (*project_remap_line_fixed_fn)(uint8_t *dst, const uint8_t *src, ptrdiff_t linesize,
+                                            const uint16_t *lut, int w, int src_w, int src_h);
+
+typedef struct ProjectRemapContext {
+    project_remap_line_fn remap_line;           ///< reads only the texels it interpolates
+    project_remap_line_fn remap_line_padded;    ///< may read PROJECT_REMAP_PADDING bytes past a row
+    project_remap_line_fixed_fn remap_line_fixed;
+    project_remap_line_fixed_fn remap_line_fixed_padded;
+} ProjectRemapContext;
+
+void ff_project_remap_line_c(uint8_t *dst, const uint8_t *src, ptrdiff_t linesize,
+                             const float *lut, int w, int src_w, int src_h);
+void ff_project_remap_line_fixed_c(uint8_t *dst, const uint8_t *src, ptrdiff_t linesize,
+                                   const uint16_t *lut, int w, int src_w, int src_h);
+
+void ff_project_remap_init(ProjectRemapContext *r);
+void ff_project_remap_init_x86(ProjectRemapContext *r);
+
+#endif
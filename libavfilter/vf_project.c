@@ -1,18 +1,38 @@
 #include <stdio.h>
-
+#include <stdatomic.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "config.h"
 #include "avfilter.h"
 #include "formats.h"
 #include "internal.h"
 #include "video.h"
 #include "libavutil/eval.h"
 #include "libavutil/avstring.h"
+#include "libavutil/dict.h"
+#include "libavutil/file.h"
 #include "libavutil/internal.h"
+#include "libavutil/intfloat.h"
+#include "libavutil/intreadwrite.h"
 #include "libavutil/libm.h"
 #include "libavutil/imgutils.h"
 #include "libavutil/mathematics.h"
 #include "libavutil/opt.h"
+#include "libavutil/sha.h"
+#include "libavutil/spherical.h"
+#include "libavutil/thread.h"
+#include "libavutil/time.h"
 
 #include "gl_utils.h"
+#include "project_embedded.h"
+#include "project_math.h"
+#include "project_remap.h"
 #include <png.h>
 
 #define ITEM_STR_LEN 128
@@ -75,7 +95,7 @@ static void push_back(vector_t *v, vector_item_t item)
 
 
 static const GLfloat back_color[] = { 0.0f, 0.0f, 0.0f, 1.0f };
-static const GLenum draw_buffers[] = { GL_COLOR_ATTACHMENT0 };
+static const GLenum draw_buffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
 
 #define ONE_THIRD (1.0f/3)
 #define TWO_THIRDS (2.0f/3)
@@ -138,6 +158,183 @@ typedef struct _tile {
     double h;
 }tile_t;
 
+enum ProjectBackend {
+    BACKEND_GL,
+    BACKEND_CPU,
+    NB_BACKENDS
+};
+
+// minification of the input textures by the GL backend
+enum ProjectMipmap {
+    MIPMAP_NONE,
+    MIPMAP_TRILINEAR,
+    MIPMAP_ANISO,
+    NB_MIPMAPS
+};
+
+// built-in fragment shaders, which the cpu backend also evaluates itself, see cpu_sample()
+enum BuiltinShader {
+    SHADER_EQDIS,
+    SHADER_EQDIS_ECOEF,
+    SHADER_EQDEG,
+    SHADER_UNEQDEG,
+    SHADER_UNEQDEG_ECOEF,
+    SHADER_EQUIRECTANGULAR,
+    SHADER_EQUIRECTANGULAR_EAC,
+    SHADER_TO_EQUIRECTANGULAR,
+    NB_BUILTIN_SHADERS
+};
+
+// size of a struct Tile of toequirectangular.glsl in its std140 uniform block
+#define TILE_UNIFORM_SIZE (5 * 4 * sizeof(GLfloat))
+
+// how the tiles of the input are sampled, the PROJECTION of tile.glsl
+enum TileSampling {
+    SAMPLING_EQDIS   = PM_EQDIS,
+    SAMPLING_EQDEG   = PM_EQDEG,
+    SAMPLING_UNEQDEG = PM_UNEQDEG,
+    NB_SAMPLINGS
+};
+
+static const char *const sampling_names[NB_SAMPLINGS] = {
+    [SAMPLING_EQDIS]   = "PM_EQDIS",
+    [SAMPLING_EQDEG]   = "PM_EQDEG",
+    [SAMPLING_UNEQDEG] = "PM_UNEQDEG",
+};
+
+/*
+ * The shader names are variants of a few sources, specialized by defines
+ * instead of uniforms so the compiler folds them away.
+ */
+typedef struct builtin_shader_t {
+    const char *name;
+    const char *file;
+    const char *defines;
+    int sampling;       ///< enum TileSampling of the input tiles, -1 for an equirectangular input
+    double ecoef;       ///< expansion coefficient of the input tiles by default, 0 where it does not apply
+} builtin_shader_t;
+
+static const builtin_shader_t builtin_fshaders[NB_BUILTIN_SHADERS] = {
+    [SHADER_EQDIS]               = { "eqdis.glsl",               "tile.glsl",             "",              SAMPLING_EQDIS,   1.0  },
+    [SHADER_EQDIS_ECOEF]         = { "eqdis-ecoef.glsl",         "tile.glsl",             "",              SAMPLING_EQDIS,   1.01 },
+    [SHADER_EQDEG]               = { "eqdeg.glsl",               "tile.glsl",             "",              SAMPLING_EQDEG,   1.01 },
+    [SHADER_UNEQDEG]             = { "uneqdeg.glsl",             "tile.glsl",             "",              SAMPLING_UNEQDEG, 1.0  },
+    [SHADER_UNEQDEG_ECOEF]       = { "uneqdeg-ecoef.glsl",       "tile.glsl",             "",              SAMPLING_UNEQDEG, 1.01 },
+    [SHADER_EQUIRECTANGULAR]     = { "equirectangular.glsl",     "equirectangular.glsl",  "",              -1,               0    },
+    [SHADER_EQUIRECTANGULAR_EAC] = { "equirectangular-eac.glsl", "equirectangular.glsl",  "#define EAC\n", -1,               0    },
+    // any input layout to an equirectangular output, sampled as the insampling option says
+    [SHADER_TO_EQUIRECTANGULAR]  = { "toequirectangular.glsl",   "toequirectangular.glsl", "",             SAMPLING_EQDIS,   1.0  },
+};
+
+// vertex.glsl projects the tiles, simpleVertex.glsl passes them through
+enum CpuVertex {
+    VERTEX_PERSPECTIVE,
+    VERTEX_PASSTHROUGH,
+    NB_CPU_VERTICES
+};
+
+static const char *const cpu_vshaders[NB_CPU_VERTICES] = {
+    [VERTEX_PERSPECTIVE] = "vertex.glsl",
+    [VERTEX_PASSTHROUGH] = "simpleVertex.glsl",
+};
+
+// element of the cpu remap tables, see project_remap.h
+enum LutFormat {
+    LUT_FLOAT,      ///< float texel coordinates, 8 bytes per pixel
+    LUT_FIXED,      ///< 12.4 fixed-point texel coordinates, 4 bytes per pixel
+    NB_LUT_FORMATS
+};
+
+// the tables are stored in blocks of output pixels, row by row within a block,
+// so the source texels read for a block stay close together
+#define LUT_BLOCK_W 64
+#define LUT_BLOCK_H 8
+
+// remap table cache file: magic, sha-256 key, little-endian uint64 size of the tables, then the tables in native byte order
+#define LUT_MAGIC "P360LUT1"
+// part of the key: bump it with any change to how the tables are computed, laid out or encoded
+#define LUT_VERSION 1
+#define LUT_KEY_SIZE 32
+#define LUT_HEADER_SIZE 64
+
+// clipping planes of the projection in DrawTiles()
+#define NEAR_PLANE 0.5
+#define FAR_PLANE  2.0
+
+// geometry of a tile as CreateTiles() builds it, for the cpu backend
+typedef struct _cpu_tile {
+    double rot[9];              ///< rotation of the tile, row-major
+    double lx, rx, by, ty;      ///< corners on the z = -1 plane
+    double p0[3], e1[3], e2[3]; ///< rotated lower left corner and edges
+    double inv[4];              ///< inverse of the edges projected on the screen
+    double det;                 ///< 0 for tiles seen edge-on
+}cpu_tile_t;
+
+typedef struct _program {
+    GLuint ProgramId;       ///< shared between instances, see AcquireProgram()
+    GLuint ProjectionMatrixUniformLocation;
+    GLuint ViewMatrixUniformLocation;
+    GLuint ModelMatrixUniformLocation;
+    GLuint ResolutionUniformLocation;
+    GLuint FovUniformLocation;
+    GLuint YawUniformLocation;
+    GLuint PitchUniformLocation;
+    GLuint RollUniformLocation;
+    GLuint RotationUniformLocation;
+    GLuint FocalUniformLocation;
+    GLuint TilesBlockIndex;
+    GLuint OriginUniformLocation;
+}program_t;
+
+typedef struct _pass {
+    int plane;              ///< first plane rendered by this pass
+    int nb_planes;          ///< planes rendered at once, one render target each
+    int program;            ///< index into ProjectContext.programs
+    int w, h;               ///< size of the render targets
+}pass_t;
+
+// render target of one filter output
+typedef struct _target {
+    int w, h;                   ///< size of the output
+    pass_t passes[3];
+    int nb_passes;
+    GLuint FramebufferIds[3];   ///< one per pass
+    GLuint RenderbufferIds[3];  ///< one per plane
+    size_t rb_offset[3];        ///< offset of each plane in the readback pbo
+    void *lut[2];               ///< cpu backend: source texels of the luma and, if subsampled, chroma pixels
+}target_t;
+
+typedef struct _view {
+    int target;                 ///< index into ProjectContext.targets
+    int x, y, w, h;             ///< rectangle of the view in its target, top-down
+    double fovx, fovy;          ///< field of view, expanded by ecoef
+    double xr, yr, zr;          ///< fixed rotation of a view from a layout file
+}view_t;
+
+typedef struct _orientation {
+    double t;               ///< time of the sample in seconds
+    double xr, yr, zr;      ///< rotations by x-, y- and z-axis in degrees
+}orientation_t;
+
+// binary orientation file: magic, little-endian uint64 count, then count orientation_t as little-endian doubles
+#define ORB_MAGIC "P360ORB1"
+#define ORB_HEADER_SIZE 16
+
+/*
+ * Latest pose of the orientation feed. The reader thread is the only writer,
+ * filter_frame() the only reader; seq is odd while a write is in progress.
+ */
+typedef struct _pose_slot {
+    atomic_uint seq;
+    atomic_uint_least64_t rot[3];   ///< x-, y- and z-rotation as av_double2int() bits
+}pose_slot_t;
+
+typedef struct _readback {
+    GLuint pbo;         ///< pixel pack buffer receiving all planes of all views of one frame
+    GLsync fence;       ///< signalled once the readback into pbo has completed
+    AVFrame **frames;   ///< output frames, one per view, waiting for the pbo contents
+}readback_t;
+
 typedef struct ProjectContext {
     const AVClass *class;
     int  x;             ///< x offset of the non-projected area with respect to the input area
@@ -161,9 +358,26 @@ typedef struct ProjectContext {
     char *vshader;
     char *fshader;
     char *orfile;
-    vector_t *ors;
+    orientation_t *ors;     ///< head orientations sorted by time
+    int nb_ors;
+    int or_cursor;          ///< sample used for the previous frame
+    uint8_t *or_map;        ///< mapped binary orientation file backing ors, if any
+    size_t or_mapsize;
+    int orinterp;           ///< interpolate between orientation samples
+
+    // live orientation feed
+    char *orfeed;           ///< unix domain socket or fifo sending "yaw pitch roll" lines
+    int feed_fd;
+    pthread_t feed_thread;
+    int feed_running;
+    atomic_int feed_stop;
+    pose_slot_t pose;
+
+    int sidedata;           ///< take the orientation from frame side data and metadata
     double tb; // time base
     double ecoef;
+    double iecoef;
+    double in_ecoef;            ///< expansion coefficient of the input tiles the shader undoes
 
     char *lofile;
     vector_t *layout;
@@ -175,44 +389,103 @@ typedef struct ProjectContext {
     Matrix ProjectionMatrix;
     Matrix ViewMatrix;
 
-    GLuint ProjectionMatrixUniformLocation;
-    GLuint ViewMatrixUniformLocation;
-    GLuint ModelMatrixUniformLocation;
-    GLuint ResolutionUniformLocation;
-    GLuint FovUniformLocation;
-    GLuint YawUniformLocation;
-    GLuint PitchUniformLocation;
-    GLuint RollUniformLocation;
-    GLuint ShaderIds[3];
+    // programs[0] renders one plane, programs[1] all planes of a multiple render target pass,
+    // programs[2] the plane with several channels of semi-planar or packed formats
+    program_t programs[3];
     GLuint BufferIds[4];
-
-    GLuint TextureId;
-
-    GLuint FramebufferId;
-    GLuint RenderbufferId;
-
-    GLuint FramebufferId2;
-    GLuint RenderbufferId2;
-
-    // GLFW window handle
-    GLFWwindow* WindowHandle;
-
-    // store the original data from frames as texture
-    uint8_t *ori_buffer[3];
+    GLfloat *tile_block;        ///< Tiles block of toequirectangular.glsl, extents and rectangles set by CreateTiles()
+    double *tile_rays;          ///< erp_tile_matrices() of tile_rotations
+    double tile_rotations[3];   ///< orientation the rows of the Tiles block were uploaded for
+    int tile_rows_set;          ///< the rows on the GPU match tile_rotations
+
+    int mrt;                ///< render planes of equal size in a single draw
+
+    // per-plane resources, allocated once in config_input()
+    GLuint TextureIds[3];
+    int tex_w[3], tex_h[3];
+    int tex_levels[3];      ///< mip levels of each texture, 1 without mipmap
+    int mipmap;             ///< enum ProjectMipmap
+    double aniso;           ///< maximum anisotropy with mipmap=aniso
+    int nb_planes;          ///< projected planes, without alpha
+    int channels[3];        ///< interleaved components of each plane, 2 for the chroma of semi-planar formats, 3 or 4 for packed RGB
+    int bytes;              ///< bytes per sample, 2 for more than 8 bits
+    GLenum InternalFormats[3];  ///< of the texture and render buffers of each plane
+    GLenum PixelFormats[3];     ///< GL_RED, GL_RG, GL_RGB or GL_RGBA, of the samples uploaded and read back
+    GLfloat clear_colors[3][4]; ///< of the render buffers of each plane, opaque black in the order of the bytes
+    GLenum PixelType;
+
+    // views rendered from the same textures, into one or several outputs
+    char *viewsfile;        ///< layout file of views rendered to separate outputs
+    char *olofile;          ///< layout file of views rendered into one output
+    int align;              ///< alignment of the view sizes and positions from a layout file
+    vector_t *view_layout;
+    tile_t *view_tiles;     ///< NULL for a single view following the head orientation
+    view_t *views;
+    int nb_views;
+    target_t *targets;
+    int nb_targets;
+    AVFrame **outs;         ///< output frames of the current input frame, one per target
+
+    // asynchronous readback: ring of pipeline + 1 pixel buffer objects
+    int pipeline;               ///< number of frames held back while the GPU catches up, 0 reads synchronously
+    readback_t *readbacks;
+    int nb_readbacks;
+    int rb_head;                ///< oldest queued readback
+    int rb_queued;              ///< number of queued readbacks
+    size_t rb_size;             ///< size of each pbo
+
+    // shared GL context
+    int gl_ready;           ///< holds a reference to the shared GL context
+
+    // cpu backend: lookup tables of the source texel of each output pixel
+    int backend;
+    ProjectRemapContext remap;
+    int cpu_vertex;
+    int shader;                 ///< enum BuiltinShader of the fragment shader, -1 for other ones
+    int sampling;               ///< enum TileSampling of the input tiles of the built-in shader, -1 if it has none
+    int insampling;
+    cpu_tile_t *cpu_tiles;
+    int lutfmt;
+    int lut_fixed;              ///< the tables are in LUT_FIXED format
+    int lut_rotates;            ///< the tables depend on the orientation
+    int lut_valid;
+    double lut_rotations[3];    ///< orientation the tables were built for
+    int nb_lut_builds, nb_remapped;
+    char *cachedir;             ///< directory of remap tables and program binaries shared between runs
+    uint8_t *lut_map;           ///< mapped cache file backing the tables, if any
+    size_t lut_mapsize;
+    int nb_lut_loads;
+    int64_t lut_time, remap_time;   ///< in microseconds
+
+    int fr_idx;             ///< frames passed to filter_frame()
+    int nb_draws;           ///< DrawTiles() calls
 
 } ProjectContext;
 
 static av_cold void uninit(AVFilterContext *ctx);
+static av_cold int create_outputs(AVFilterContext *ctx);
+static av_cold int init_cpu_backend(AVFilterContext *ctx);
+static void free_luts(ProjectContext *s);
+static size_t lut_total_size(const ProjectContext *s);
+static int config_output(AVFilterLink *link);
+static int request_frame(AVFilterLink *link);
 
 int CreateTiles(AVFilterContext *ctx);
-int DrawTiles(AVFilterContext *ctx, double rotations[3], const GLfloat res[2]);
+int CreateProgram(AVFilterContext *ctx, program_t *prog, int planes, int channels);
+int DrawTiles(AVFilterContext *ctx, program_t *prog, const view_t *view, double rotations[3], const GLfloat res[2], const GLfloat origin[2]);
+void DestroyProgram(AVFilterContext *ctx, program_t *prog);
 void DestroyCube(AVFilterContext *ctx);
-int CreateTexutre(AVFilterContext *ctx);
-void LoadTexture(AVFilterContext *ctx, int w, int h, uint8_t *img);
+int CreateTexutre(AVFilterContext *ctx, int plane, int w, int h);
+void LoadTexture(AVFilterContext *ctx, int plane, int linesize, const uint8_t *img);
 void DestroyTexture(AVFilterContext *ctx);
-void CreateFramebuffer(AVFilterContext *ctx, int w, int h);
-void CreateFramebuffer2(AVFilterContext *ctx, int w, int h);
+int CreateRenderbuffer(AVFilterContext *ctx, target_t *target, int plane, int w, int h);
+int CreateFramebuffer(AVFilterContext *ctx, target_t *target, int pass);
 void DestroyFramebuffer(AVFilterContext *ctx);
+int CreateReadbacks(AVFilterContext *ctx);
+void DestroyReadbacks(AVFilterContext *ctx);
+void ReadPlane(AVFilterContext *ctx, const target_t *target, AVFrame *frame, int plane, int w, int h);
+int QueueReadback(AVFilterContext *ctx, AVFrame **frames);
+int FlushReadbacks(AVFilterContext *ctx, int max_queued);
 void printPixelFormat(AVFilterContext *ctx, const AVPixFmtDescriptor *desc);
 
 void write_png_file(char *filename, int w, int h, uint8_t *d);
@@ -247,110 +520,552 @@ static int parseArgsf(char *line, double *args, const char *del)
     return parsed;
 }
 
+static int pass_max_planes(const ProjectContext *s)
+{
+    int i, planes = 1;
+
+    // all targets group their planes the same way
+    for(i = 0; s->targets && i < s->targets[0].nb_passes; i++)
+        planes = FFMAX(planes, s->targets[0].passes[i].nb_planes);
+    return planes;
+}
+
+// planar formats, every plane is projected on its own
+static const enum AVPixelFormat pix_fmts_8bit[] = {
+    AV_PIX_FMT_YUV420P,  AV_PIX_FMT_YUV422P,  AV_PIX_FMT_YUV444P,
+    AV_PIX_FMT_YUV410P,  AV_PIX_FMT_YUV411P,  AV_PIX_FMT_YUV440P,
+    AV_PIX_FMT_YUVJ420P, AV_PIX_FMT_YUVJ422P, AV_PIX_FMT_YUVJ444P, AV_PIX_FMT_YUVJ440P,
+    AV_PIX_FMT_YUVA420P, AV_PIX_FMT_YUVA422P, AV_PIX_FMT_YUVA444P,
+    AV_PIX_FMT_GRAY8,    AV_PIX_FMT_GBRP,
+    AV_PIX_FMT_NONE
+};
+
+// semi-planar, the interleaved chroma plane is rendered as one two-channel plane by the GL backend
+static const enum AVPixelFormat pix_fmts_semi_planar[] = {
+    AV_PIX_FMT_NV12, AV_PIX_FMT_NV21, AV_PIX_FMT_P010, AV_PIX_FMT_P016,
+    AV_PIX_FMT_NONE
+};
+
+// packed, the whole pixel is rendered as one plane by the GL backend
+static const enum AVPixelFormat pix_fmts_packed[] = {
+    AV_PIX_FMT_RGB24, AV_PIX_FMT_BGR24,
+    AV_PIX_FMT_RGBA,  AV_PIX_FMT_BGRA,  AV_PIX_FMT_ARGB,  AV_PIX_FMT_ABGR,
+    AV_PIX_FMT_RGB0,  AV_PIX_FMT_BGR0,  AV_PIX_FMT_0RGB,  AV_PIX_FMT_0BGR,
+    AV_PIX_FMT_NONE
+};
+
+// rendered through 16-bit textures and render targets by the GL backend
+static const enum AVPixelFormat pix_fmts_16bit[] = {
+    AV_PIX_FMT_YUV420P9,  AV_PIX_FMT_YUV422P9,  AV_PIX_FMT_YUV444P9,
+    AV_PIX_FMT_YUV420P10, AV_PIX_FMT_YUV422P10, AV_PIX_FMT_YUV444P10, AV_PIX_FMT_YUV440P10,
+    AV_PIX_FMT_YUV420P12, AV_PIX_FMT_YUV422P12, AV_PIX_FMT_YUV444P12, AV_PIX_FMT_YUV440P12,
+    AV_PIX_FMT_YUV420P14, AV_PIX_FMT_YUV422P14, AV_PIX_FMT_YUV444P14,
+    AV_PIX_FMT_YUV420P16, AV_PIX_FMT_YUV422P16, AV_PIX_FMT_YUV444P16,
+    AV_PIX_FMT_GRAY10,    AV_PIX_FMT_GRAY12,    AV_PIX_FMT_GRAY16,
+    AV_PIX_FMT_GBRP9,     AV_PIX_FMT_GBRP10,    AV_PIX_FMT_GBRP12,    AV_PIX_FMT_GBRP14, AV_PIX_FMT_GBRP16,
+    AV_PIX_FMT_NONE
+};
+
 static int query_formats(AVFilterContext *ctx)
 {
+    ProjectContext *s = ctx->priv;
     AVFilterFormats *formats = NULL;
-    int fmt, ret;
+    int i, ret;
 
-    for (fmt = 0; av_pix_fmt_desc_get(fmt); fmt++) {
-        const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(fmt);
-        if (!(desc->flags & (AV_PIX_FMT_FLAG_HWACCEL | AV_PIX_FMT_FLAG_BITSTREAM)) &&
-            !((desc->log2_chroma_w || desc->log2_chroma_h) && !(desc->flags & AV_PIX_FMT_FLAG_PLANAR)) &&
-            (ret = ff_add_format(&formats, fmt)) < 0)
+    for(i = 0; pix_fmts_8bit[i] != AV_PIX_FMT_NONE; i++)
+        if((ret = ff_add_format(&formats, pix_fmts_8bit[i])) < 0)
+            return ret;
+    // the cpu remap kernels are 8-bit only and read one sample per pixel
+    for(i = 0; s->backend == BACKEND_GL && pix_fmts_16bit[i] != AV_PIX_FMT_NONE; i++)
+        if((ret = ff_add_format(&formats, pix_fmts_16bit[i])) < 0)
+            return ret;
+    for(i = 0; s->backend == BACKEND_GL && pix_fmts_semi_planar[i] != AV_PIX_FMT_NONE; i++)
+        if((ret = ff_add_format(&formats, pix_fmts_semi_planar[i])) < 0)
+            return ret;
+    for(i = 0; s->backend == BACKEND_GL && pix_fmts_packed[i] != AV_PIX_FMT_NONE; i++)
+        if((ret = ff_add_format(&formats, pix_fmts_packed[i])) < 0)
             return ret;
-    }
 
     return ff_set_common_formats(ctx, formats);
 }
 
-/* void errorCallback(int errno, const char * description) */
-/* { */
-/*     fprintf(stderr, "Error: %s\n", description); */
-/* } */
+// The GL context is shared by all instances and only created once an input is configured
+static int gl_init(AVFilterContext *ctx)
+{
+    ProjectContext *s = ctx->priv;
+
+    if(AcquireGLContext(ctx))
+        return -1;
+    s->gl_ready = 1;
+
+    s->ModelMatrix = IDENTITY_MATRIX;
+    s->ProjectionMatrix = IDENTITY_MATRIX;
+    s->ViewMatrix = IDENTITY_MATRIX;
+
+    return 0;
+}
+
+
+static void free_orientations(AVFilterContext *ctx)
+{
+    ProjectContext *s = ctx->priv;
+
+    if(s->or_map)
+        av_file_unmap(s->or_map, s->or_mapsize);
+    else
+        av_free(s->ors);
+    s->or_map = NULL;
+    s->or_mapsize = 0;
+    s->ors = NULL;
+    s->nb_ors = 0;
+    s->or_cursor = 0;
+}
+
+static int compare_orientations(const void *a, const void *b)
+{
+    const orientation_t *o1 = a, *o2 = b;
+    return (o1->t > o2->t) - (o1->t < o2->t);
+}
 
-static int InitWindow(AVFilterContext *ctx)
+static int load_orientations_binary(AVFilterContext *ctx, uint8_t *buf, size_t size)
 {
     ProjectContext *s = ctx->priv;
+    uint64_t count = AV_RL64(buf + 8);
+    int i;
+
+    if(count > INT_MAX || count != (size - ORB_HEADER_SIZE) / sizeof(orientation_t) ||
+       (size - ORB_HEADER_SIZE) % sizeof(orientation_t)){
+        av_log(ctx, AV_LOG_ERROR, "[Project Filter] load_orfile(): %s is truncated or corrupt\n", s->orfile);
+        av_file_unmap(buf, size);
+        return AVERROR_INVALIDDATA;
+    }
+    s->nb_ors = count;
+
+#if !HAVE_BIGENDIAN
+    // the samples are used in place
+    s->or_map = buf;
+    s->or_mapsize = size;
+    s->ors = (orientation_t *)(buf + ORB_HEADER_SIZE);
+#else
+    if(!(s->ors = av_malloc_array(count, sizeof(orientation_t)))){
+        av_file_unmap(buf, size);
+        return AVERROR(ENOMEM);
+    }
+    for(i = 0; i < s->nb_ors; i++){
+        const uint8_t *p = buf + ORB_HEADER_SIZE + i * sizeof(orientation_t);
+        s->ors[i].t  = av_int2double(AV_RL64(p));
+        s->ors[i].xr = av_int2double(AV_RL64(p + 8));
+        s->ors[i].yr = av_int2double(AV_RL64(p + 16));
+        s->ors[i].zr = av_int2double(AV_RL64(p + 24));
+    }
+    av_file_unmap(buf, size);
+#endif
 
-    /* glfwSetErrorCallback(errorCallback); */
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 2);
-    glfwWindowHint (GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-    glfwWindowHint (GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
-
-    s->WindowHandle = glfwCreateWindow (640, 640, "OpenGL", NULL, NULL);
-    if (! s->WindowHandle) {
-      av_log(ctx, AV_LOG_ERROR, "[OpenGL] ERROR: could not open window with GLFW3\n");
-      glfwTerminate ();
-      return -1;
-    }
-    glfwMakeContextCurrent (s->WindowHandle);
- 
+    for(i = 1; i < s->nb_ors; i++){
+        if(s->ors[i].t < s->ors[i - 1].t){
+            av_log(ctx, AV_LOG_ERROR, "[Project Filter] load_orfile(): samples of %s are not sorted by time\n", s->orfile);
+            return AVERROR_INVALIDDATA;
+        }
+    }
     return 0;
 }
 
-static int gl_init(AVFilterContext *ctx)
+static int load_orientations_text(AVFilterContext *ctx)
 {
     ProjectContext *s = ctx->priv;
-    GLenum GlewInitResult;
+    FILE *fp;
+    char line[128];
+    double args[4];
+    int parsed, sorted = 1, lineno = 0, size = 0;
+    orientation_t *ors;
+
+    fp = fopen(s->orfile, "r");
+    if(fp == NULL){
+        av_log(ctx, AV_LOG_ERROR, "[Project Filter] load_orfile(): Failed to open file %s\n", s->orfile);
+        return AVERROR(EIO);
+    }
 
-    if(InitWindow(ctx))
-        return -1;
+    // each line is "time frame x-rotation y-rotation"
+    while(readLine(fp, line, 128) > 0){
+        lineno++;
+        parsed = parseArgsf(line, args, " ");
+        if(!parsed)
+            continue;
+        if(parsed != 4){
+            av_log(ctx, AV_LOG_ERROR, "[Project Filter] Error on parsing file %s line %d\n", s->orfile, lineno);
+            fclose(fp);
+            return AVERROR_INVALIDDATA;
+        }
 
-    glewExperimental = GL_TRUE;
-    GlewInitResult = glewInit();
-    if(GLEW_OK != GlewInitResult){
-        av_log(ctx, AV_LOG_ERROR, "[OpenGL] GLEW initialization failed: %s\n", glewGetErrorString(GlewInitResult));
-        return -1;
+        if(s->nb_ors == size){
+            size = size ? size * 2 : 1024;
+            if(!(ors = av_realloc_array(s->ors, size, sizeof(orientation_t)))){
+                fclose(fp);
+                return AVERROR(ENOMEM);
+            }
+            s->ors = ors;
+        }
+        ors = &s->ors[s->nb_ors++];
+        ors->t  = args[0];
+        ors->xr = args[2];
+        ors->yr = args[3];
+        ors->zr = 0.0;
+        if(s->nb_ors > 1 && ors->t < ors[-1].t)
+            sorted = 0;
     }
+    fclose(fp);
 
-    av_log(ctx, AV_LOG_INFO, "[OpenGL] OpenGL Version: %s\n", glGetString(GL_VERSION));
+    if(!sorted){
+        av_log(ctx, AV_LOG_WARNING, "[Project Filter] load_orfile(): samples of %s are not sorted by time, sorting\n", s->orfile);
+        qsort(s->ors, s->nb_ors, sizeof(orientation_t), compare_orientations);
+    }
+    return 0;
+}
 
-    glGetError();
-    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+static av_cold int load_orfile(AVFilterContext *ctx)
+{
+    ProjectContext *s = ctx->priv;
+    uint8_t *buf;
+    size_t size;
+    int ret;
 
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
+    free_orientations(ctx);
 
-    if(CheckGLError(ctx, "ERROR: Could not set OpenGL depth testing options"))
-        return -1;
+    if(!strcmp(s->orfile, ""))
+        return 0;
 
-    if(CreateTexutre(ctx))
-        return -1;
+    av_log(ctx, AV_LOG_INFO, "[Project Filter] load_orfile(): Read head orientations from %s\n", s->orfile);
 
-    s->ModelMatrix = IDENTITY_MATRIX;
-    s->ProjectionMatrix = IDENTITY_MATRIX;
-    s->ViewMatrix = IDENTITY_MATRIX;
+    if(ret = av_file_map(s->orfile, &buf, &size, 0, ctx)){
+        av_log(ctx, AV_LOG_ERROR, "[Project Filter] load_orfile(): Failed to open file %s\n", s->orfile);
+        return ret;
+    }
 
-    memset(s->ShaderIds, 0, sizeof(s->ShaderIds));
-    memset(s->BufferIds, 0, sizeof(s->BufferIds));
-    s->TextureId = 0;
-    s->FramebufferId = 0;
-    s->RenderbufferId = 0;
-    s->FramebufferId2 = 0;
-    s->RenderbufferId2 = 0;
+    if(size >= ORB_HEADER_SIZE && !memcmp(buf, ORB_MAGIC, 8))
+        ret = load_orientations_binary(ctx, buf, size);
+    else{
+        av_file_unmap(buf, size);
+        ret = load_orientations_text(ctx);
+    }
 
+    if(ret < 0){
+        free_orientations(ctx);
+        return ret;
+    }
+
+    av_log(ctx, AV_LOG_INFO, "[Project Filter] load_orfile(): %d orientation samples loaded\n", s->nb_ors);
     return 0;
 }
 
+/*
+ * Orientation of the last sample at or before t, slerped towards the next one
+ * with orinterp. Before the first sample the rotation options apply.
+ */
+static void lookup_orientation(AVFilterContext *ctx, double t, double rotations[3])
+{
+    ProjectContext *s = ctx->priv;
+    const orientation_t *o;
+    Quaternion q1, q2, q;
+    double next[3];
+    int i = s->or_cursor, steps, lo, hi, mid;
+
+    if(!s->nb_ors || isnan(t) || t < s->ors[0].t)
+        return;
+
+    // playback advances a sample or two per frame, anything else is a seek
+    for(steps = 0; steps < 8 && i + 1 < s->nb_ors && s->ors[i + 1].t <= t; steps++)
+        i++;
+    if(s->ors[i].t > t || (i + 1 < s->nb_ors && s->ors[i + 1].t <= t)){
+        lo = 0;
+        hi = s->nb_ors - 1;
+        while(lo < hi){
+            mid = lo + (hi - lo + 1) / 2;
+            if(s->ors[mid].t <= t)
+                lo = mid;
+            else
+                hi = mid - 1;
+        }
+        i = lo;
+    }
+    s->or_cursor = i;
+
+    o = &s->ors[i];
+    rotations[0] = o->xr;
+    rotations[1] = o->yr;
+    rotations[2] = o->zr;
+
+    if(s->orinterp && i + 1 < s->nb_ors && o[1].t > o->t){
+        next[0] = o[1].xr;
+        next[1] = o[1].yr;
+        next[2] = o[1].zr;
+        q1 = EulerToQuaternion(rotations);
+        q2 = EulerToQuaternion(next);
+        q = SlerpQuaternions(&q1, &q2, (t - o->t) / (o[1].t - o->t));
+        QuaternionToEuler(&q, rotations);
+    }
+}
+
+static void write_pose(pose_slot_t *slot, const double rotations[3])
+{
+    unsigned seq = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+    int i;
 
-static av_cold int init(AVFilterContext *ctx)
+    atomic_store_explicit(&slot->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    for(i = 0; i < 3; i++)
+        atomic_store_explicit(&slot->rot[i], av_double2int(rotations[i]), memory_order_relaxed);
+    atomic_store_explicit(&slot->seq, seq + 2, memory_order_release);
+}
+
+// returns 0 if no pose has been received yet
+static int read_pose(pose_slot_t *slot, double rotations[3])
+{
+    unsigned seq1, seq2;
+    uint64_t rot[3];
+    int i;
+
+    do{
+        seq1 = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        for(i = 0; i < 3; i++)
+            rot[i] = atomic_load_explicit(&slot->rot[i], memory_order_relaxed);
+        atomic_thread_fence(memory_order_acquire);
+        seq2 = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+    }while(seq1 != seq2 || (seq1 & 1));
+
+    if(!seq1)
+        return 0;
+    for(i = 0; i < 3; i++)
+        rotations[i] = av_int2double(rot[i]);
+    return 1;
+}
+
+static int open_feed(AVFilterContext *ctx)
+{
+    ProjectContext *s = ctx->priv;
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    struct stat st;
+    int fd;
+
+    if(stat(s->orfeed, &st))
+        return AVERROR(errno);
+
+    if(S_ISFIFO(st.st_mode)){
+        // opening for writing as well keeps read() from reporting EOF while no tracker is attached (Linux)
+        fd = open(s->orfeed, O_RDWR | O_NONBLOCK);
+        return fd < 0 ? AVERROR(errno) : fd;
+    }
+
+    if(!S_ISSOCK(st.st_mode) || strlen(s->orfeed) >= sizeof(addr.sun_path))
+        return AVERROR(EINVAL);
+
+    av_strlcpy(addr.sun_path, s->orfeed, sizeof(addr.sun_path));
+    if((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0)
+        return AVERROR(errno);
+    if(connect(fd, (struct sockaddr *)&addr, sizeof(addr)) ||
+       fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK)){
+        close(fd);
+        return AVERROR(errno);
+    }
+    return fd;
+}
+
+static void parse_feed_line(AVFilterContext *ctx, const char *line)
+{
+    ProjectContext *s = ctx->priv;
+    double yaw, pitch, roll, rotations[3];
+
+    if(sscanf(line, "%lf %lf %lf", &yaw, &pitch, &roll) != 3){
+        av_log(ctx, AV_LOG_WARNING, "[Project Filter] orfeed: ignoring malformed line '%s'\n", line);
+        return;
+    }
+    rotations[0] = pitch;
+    rotations[1] = yaw;
+    rotations[2] = roll;
+    write_pose(&s->pose, rotations);
+}
+
+static void *feed_reader(void *arg)
+{
+    AVFilterContext *ctx = arg;
+    ProjectContext *s = ctx->priv;
+    char buf[1024], *end, *line;
+    struct pollfd pfd;
+    int len = 0;
+    ssize_t n;
+
+    while(!atomic_load(&s->feed_stop)){
+        // (re)connect, e.g. after the tracker restarted
+        if(s->feed_fd < 0 && (s->feed_fd = open_feed(ctx)) < 0){
+            av_usleep(100000);
+            continue;
+        }
+
+        pfd.fd = s->feed_fd;
+        pfd.events = POLLIN;
+        if(poll(&pfd, 1, 100) <= 0)
+            continue;
+
+        n = read(s->feed_fd, buf + len, sizeof(buf) - 1 - len);
+        if(n < 0 && (errno == EAGAIN || errno == EINTR))
+            continue;
+        if(n <= 0){
+            av_log(ctx, AV_LOG_WARNING, "[Project Filter] orfeed: %s closed, reconnecting\n", s->orfeed);
+            close(s->feed_fd);
+            s->feed_fd = -1;
+            len = 0;
+            continue;
+        }
+        len += n;
+        buf[len] = '\0';
+
+        // only the newest complete line matters
+        if(!(end = strrchr(buf, '\n'))){
+            if(len == sizeof(buf) - 1)
+                len = 0;
+            continue;
+        }
+        *end = '\0';
+        line = strrchr(buf, '\n');
+        line = line ? line + 1 : buf;
+        if(*line)
+            parse_feed_line(ctx, line);
+
+        len -= end + 1 - buf;
+        memmove(buf, end + 1, len);
+    }
+
+    return NULL;
+}
+
+static av_cold int start_feed(AVFilterContext *ctx)
+{
+    ProjectContext *s = ctx->priv;
+    struct stat st;
+    int ret;
+
+    if(stat(s->orfeed, &st) || !(S_ISSOCK(st.st_mode) || S_ISFIFO(st.st_mode))){
+        av_log(ctx, AV_LOG_ERROR, "[Project Filter] orfeed: %s is not a unix domain socket or fifo\n", s->orfeed);
+        return AVERROR(EINVAL);
+    }
+
+    av_log(ctx, AV_LOG_INFO, "[Project Filter] Read head orientations from %s %s\n",
+           S_ISSOCK(st.st_mode) ? "socket" : "fifo", s->orfeed);
+
+    atomic_init(&s->pose.seq, 0);
+    atomic_init(&s->feed_stop, 0);
+    if(ret = pthread_create(&s->feed_thread, NULL, feed_reader, ctx)){
+        av_log(ctx, AV_LOG_ERROR, "[Project Filter] orfeed: failed to create the reader thread\n");
+        return AVERROR(ret);
+    }
+    s->feed_running = 1;
+    return 0;
+}
+
+static av_cold void stop_feed(AVFilterContext *ctx)
+{
+    ProjectContext *s = ctx->priv;
+
+    if(s->feed_running){
+        atomic_store(&s->feed_stop, 1);
+        pthread_join(s->feed_thread, NULL);
+        s->feed_running = 0;
+    }
+    if(s->feed_fd >= 0)
+        close(s->feed_fd);
+    s->feed_fd = -1;
+}
+
+static const char *const pose_keys[3] = {
+    "lavfi.project.pitch",
+    "lavfi.project.yaw",
+    "lavfi.project.roll",
+};
+
+/*
+ * Orientation attached to the frame upstream: spherical mapping side data,
+ * overridden angle by angle by lavfi.project.{yaw,pitch,roll} metadata.
+ */
+static void frame_orientation(AVFilterContext *ctx, const AVFrame *frame, double rotations[3])
+{
+    AVFrameSideData *sd = av_frame_get_side_data(frame, AV_FRAME_DATA_SPHERICAL);
+    AVDictionaryEntry *e;
+    char *end;
+    double d;
+    int i;
+
+    // sizeof(AVSphericalMapping) is not part of the ABI, only the fields read have to be there
+    if(sd && sd->size >= offsetof(AVSphericalMapping, roll) + sizeof(((AVSphericalMapping *)0)->roll)){
+        const AVSphericalMapping *map = (const AVSphericalMapping *)sd->data;
+        // 16.16 fixed point degrees
+        rotations[0] = map->pitch / 65536.0;
+        rotations[1] = map->yaw / 65536.0;
+        rotations[2] = map->roll / 65536.0;
+    }
+
+    for(i = 0; i < 3; i++){
+        if(!(e = av_dict_get(frame->metadata, pose_keys[i], NULL, 0)))
+            continue;
+        d = strtod(e->value, &end);
+        if(end == e->value || *end || !isfinite(d)){
+            av_log(ctx, AV_LOG_WARNING, "[Project Filter] ignoring invalid %s=%s\n", e->key, e->value);
+            continue;
+        }
+        rotations[i] = d;
+    }
+}
+
+// Find the built-in variant of the fragment shader and the expansion of the input tiles it undoes
+static av_cold int init_shader(AVFilterContext *ctx)
 {
     ProjectContext *s = ctx->priv;
     int i;
 
+    s->shader = s->sampling = -1;
+    for(i = 0; i < NB_BUILTIN_SHADERS; i++)
+        if(!strcmp(s->fshader, builtin_fshaders[i].name))
+            s->shader = i;
+    if(s->shader >= 0)
+        s->sampling = s->shader == SHADER_TO_EQUIRECTANGULAR ? s->insampling : builtin_fshaders[s->shader].sampling;
+
+    // the equirectangular output is drawn as one quad over each view
+    if(s->shader == SHADER_TO_EQUIRECTANGULAR && strcmp(s->vshader, cpu_vshaders[VERTEX_PASSTHROUGH])){
+        av_log(ctx, AV_LOG_ERROR, "[Project Filter] %s needs the vertex shader %s\n", s->fshader, cpu_vshaders[VERTEX_PASSTHROUGH]);
+        return AVERROR(EINVAL);
+    }
+
+    s->in_ecoef = 1.0;
+    if(s->shader >= 0 && builtin_fshaders[s->shader].ecoef)
+        s->in_ecoef = s->iecoef ? s->iecoef : builtin_fshaders[s->shader].ecoef;
+    else if(s->iecoef)
+        av_log(ctx, AV_LOG_WARNING, "[Project Filter] iecoef does not apply to the fragment shader %s\n", s->fshader);
+
+    return 0;
+}
+
+static av_cold int init(AVFilterContext *ctx)
+{
+    ProjectContext *s = ctx->priv;
+    int ret;
+
+    // uninit() closes the feed, also when init() fails early
+    s->feed_fd = -1;
+
     av_log(ctx, AV_LOG_INFO, "[Project Filter] Initializing project filter...\n");
 
-    for(i = 0; i < 3; i++)
-        s->ori_buffer[i] = NULL;
-    s->ors = init_vector();
     s->layout = init_vector();
+    s->view_layout = init_vector();
 
-    av_log(ctx, AV_LOG_INFO, "[Project Filter] Initialize OpenGL context\n");
-    if(gl_init(ctx))
-        return AVERROR(ENOSYS);
+    if((ret = create_outputs(ctx)) < 0)
+        return ret;
+
+    if((ret = init_shader(ctx)) < 0)
+        return ret;
+
+    if(s->backend == BACKEND_CPU && (ret = init_cpu_backend(ctx)) < 0)
+        return ret;
+
+    if(strcmp(s->orfeed, "") && (ret = start_feed(ctx)) < 0)
+        return ret;
 
     av_log(ctx, AV_LOG_INFO, "[Project Filter] Initialization done\n");
     return 0;
@@ -363,26 +1078,43 @@ static av_cold void uninit(AVFilterContext *ctx)
 
     av_log(ctx, AV_LOG_INFO, "[Project Filter] uninit(): Uninitializing project filter...\n");
 
-    DestroyCube(ctx);
-    DestroyFramebuffer(ctx);
-    DestroyTexture(ctx);
-
-    if(s->layout->nr > 0){
-        free(s->tiles);
-        free(s->vertices);
+    stop_feed(ctx);
+    if(s->gl_ready){
+        LockGLContext();
+        DestroyReadbacks(ctx);
+        DestroyCube(ctx);
+        DestroyFramebuffer(ctx);
+        DestroyTexture(ctx);
+        UnlockGLContext();
+        ReleaseGLContext(ctx);
+        s->gl_ready = 0;
     }
 
-    destroy_vector(s->ors);
+    av_log(ctx, AV_LOG_DEBUG, "[Project Filter] %d frame(s), %d draw call(s)\n", s->fr_idx, s->nb_draws);
+    if(s->nb_remapped)
+        av_log(ctx, AV_LOG_INFO, "[Project Filter] cpu backend: %.1f MiB of %s lookup tables, %d build(s) in %.1f ms, %d mapped from the cache, %d frame(s) remapped in %.1f ms, %.2f ms per frame\n",
+               lut_total_size(s) / 1048576.0, s->lut_fixed ? "fixed-point" : "float", s->nb_lut_builds, s->lut_time / 1000.0, s->nb_lut_loads, s->nb_remapped, s->remap_time / 1000.0, s->remap_time / 1000.0 / s->nb_remapped);
+    free_luts(s);
+    av_freep(&s->cpu_tiles);
+
+    free(s->tiles);
+    free(s->vertices);
+
+    free_orientations(ctx);
     destroy_vector(s->layout);
 
+    free(s->view_tiles);
+    destroy_vector(s->view_layout);
+    av_freep(&s->views);
+    av_freep(&s->targets);
+    av_freep(&s->outs);
+    for(i = 0; i < ctx->nb_outputs; i++)
+        av_freep(&ctx->output_pads[i].name);
+
     av_expr_free(s->x_pexpr);
     s->x_pexpr = NULL;
     av_expr_free(s->y_pexpr);
     s->y_pexpr = NULL;
-
-    for(i = 0; i < 3; i++)
-        if(s->ori_buffer[i] != NULL)
-            free(s->ori_buffer[i]);
 }
 
 static inline int normalize_double(int *n, double d)
@@ -400,37 +1132,6 @@ static inline int normalize_double(int *n, double d)
     return ret;
 }
 
-static av_cold int load_orfile(AVFilterContext *ctx)
-{
-    ProjectContext *s = ctx->priv;
-
-    FILE *fp;
-    char line[128];
-    int ret;
-    vector_item_t item;
-
-    s->ors = init_vector();
-
-    if(strcmp(s->orfile, "")){
-        av_log(ctx, AV_LOG_INFO, "[Project Filter] load_rofile(): Read head orientations from %s\n", s->orfile);
-        fp = fopen(s->orfile, "r");
-        if(fp == NULL){
-            av_log(ctx, AV_LOG_ERROR, "[Project Filter] load_orfile(): Failed to open file %s\n", s->orfile);
-            return EIO;
-        }
-
-        while( (ret = readLine(fp, line, 128)) > 0 ){
-            memcpy(item.str, line, 128);
-            push_back(s->ors, item);
-        }
-
-        //pr_items_str(s->ors);
-        fclose(fp);
-    }
-
-    return 0;
-}
-
 static const char *cube_layout[6] = {
     "0.333333:0.5:90:90:0:0:0:0.333333:0.5",
     "0.333333:0.5:90:90:90:0:0:0.666667:0",
@@ -440,102 +1141,985 @@ static const char *cube_layout[6] = {
     "0.333333:0.5:90:90:0:180:0:0.666667:0.5",
 };
 
-static av_cold int load_lofile(AVFilterContext *ctx)
+// Layouts are built into the filter, other layout files are looked up in ffmpeg360_layout/;
+// a name with a '/' is the path of the file itself
+static av_cold int read_layout(AVFilterContext *ctx, const char *file, vector_t *layout)
 {
-    ProjectContext *s = ctx->priv;
-
-    FILE *fp;
+    FILE *fp = NULL;
     char line[128];
     int ret, i;
     vector_item_t item;
 
-    if(strcmp(s->lofile, "")){
-        av_log(ctx, AV_LOG_INFO, "[Project Filter] load_lofile(): read layout from %s\n", s->lofile);
+    for(i = 0; !strchr(file, '/') && ff_project_layouts[i].name; i++){
+        if(!strcmp(file, ff_project_layouts[i].name)){
+            fp = fmemopen((void *)ff_project_layouts[i].data, strlen(ff_project_layouts[i].data), "r");
+            break;
+        }
+    }
 
+    if(strchr(file, '/'))
+        fp = fopen(file, "r");
+    else if(!ff_project_layouts[i].name){
         const char* layout_dir = "ffmpeg360_layout/";
-        const size_t layout_path_length = strlen(layout_dir) + strlen(s->lofile) + 1;
+        const size_t layout_path_length = strlen(layout_dir) + strlen(file) + 1;
         char* layout_path = malloc(layout_path_length);
 
-        snprintf(layout_path, layout_path_length, "%s%s", layout_dir, s->lofile);
+        snprintf(layout_path, layout_path_length, "%s%s", layout_dir, file);
 
         fp = fopen(layout_path, "r");
         free(layout_path);
+    }
 
-        if(fp == NULL){
-            av_log(ctx, AV_LOG_ERROR, "[Project Filter] load_lofile(): failed to open file %s\n", s->lofile);
-            return EIO;
-        }
-
-        while( (ret = readLine(fp, line, 128)) > 0 ){
-            memcpy(item.str, line, 128);
-            push_back(s->layout, item);
-        }
+    if(fp == NULL){
+        av_log(ctx, AV_LOG_ERROR, "[Project Filter] read_layout(): failed to open file %s\n", file);
+        return EIO;
+    }
 
-        //pr_items_str(s->layout);
-        fclose(fp);
-    }else{
-        for(i = 0; i < 6; i++){
-            memcpy(item.str, cube_layout[i], 128);
-            push_back(s->layout, item);
-        }
+    while( (ret = readLine(fp, line, 128)) > 0 ){
+        memcpy(item.str, line, 128);
+        push_back(layout, item);
     }
+
+    //pr_items_str(layout);
+    fclose(fp);
     return 0;
 }
 
-static av_cold int parse_tiles(AVFilterContext *ctx)
+static av_cold int load_lofile(AVFilterContext *ctx)
 {
     ProjectContext *s = ctx->priv;
 
+    int i;
+    vector_item_t item;
+
+    if(strcmp(s->lofile, "")){
+        av_log(ctx, AV_LOG_INFO, "[Project Filter] load_lofile(): read layout from %s\n", s->lofile);
+        return read_layout(ctx, s->lofile, s->layout);
+    }
+
+    for(i = 0; i < 6; i++){
+        memcpy(item.str, cube_layout[i], 128);
+        push_back(s->layout, item);
+    }
+    return 0;
+}
+
+static av_cold int parse_tiles(AVFilterContext *ctx, const char *file, vector_t *layout, tile_t **ptiles)
+{
     char line[128];
     int parsed, i;
     double tile_args[9];
+    tile_t *tiles;
 
-    if(s->layout->nr == 0){
+    if(layout->nr == 0){
         av_log(ctx, AV_LOG_ERROR, "[Project Filter] no tile representation to parse!\n");
         return EINVAL;
     }
 
-    s->tiles = malloc(sizeof(tile_t) * s->layout->nr);
+    *ptiles = tiles = malloc(sizeof(tile_t) * layout->nr);
 
-    for(i = 0; i < s->layout->nr; i++){
-        memcpy(line, s->layout->head[i].str, 128);
+    for(i = 0; i < layout->nr; i++){
+        memcpy(line, layout->head[i].str, 128);
         parsed = parseArgsf(line, tile_args, ":");
         // every line: w:h:fovx:fovy:xr:yr:zr:u:v
         if(parsed != 9){
-            av_log(ctx, AV_LOG_ERROR, "[Project Filter] Error on parsing layout file %s line %d: %s\n", s->lofile, i+1, s->layout->head[i].str);
+            av_log(ctx, AV_LOG_ERROR, "[Project Filter] Error on parsing layout file %s line %d: %s\n", file, i+1, layout->head[i].str);
             av_log(ctx, AV_LOG_ERROR, "[Project Filter] Parsed result: %d - %f %f %f %f %f %f %f %f %f\n",
                    parsed, tile_args[0], tile_args[1], tile_args[2], tile_args[3], tile_args[4], tile_args[5],
                    tile_args[6], tile_args[7], tile_args[8]);
             return EINVAL;
         }
 
-        s->tiles[i].w = tile_args[0];
-        s->tiles[i].h = tile_args[1];
-        s->tiles[i].fovx = tile_args[2];
-        s->tiles[i].fovy = tile_args[3];
-        s->tiles[i].x = tile_args[4];
-        s->tiles[i].y = tile_args[5];
-        s->tiles[i].z = tile_args[6];
-        s->tiles[i].u = tile_args[7];
-        s->tiles[i].v = tile_args[8];
+        tiles[i].w = tile_args[0];
+        tiles[i].h = tile_args[1];
+        tiles[i].fovx = tile_args[2];
+        tiles[i].fovy = tile_args[3];
+        tiles[i].x = tile_args[4];
+        tiles[i].y = tile_args[5];
+        tiles[i].z = tile_args[6];
+        tiles[i].u = tile_args[7];
+        tiles[i].v = tile_args[8];
 
         av_log(ctx, AV_LOG_DEBUG, "[Project Filter] Tile parameters (x, y, z, fovx, fovy, u, v): %f, %f, %f, %f, %f, %f, %f, %f, %f\n",
-               s->tiles[i].x, s->tiles[i].y, s->tiles[i].z, s->tiles[i].fovx, s->tiles[i].fovy, s->tiles[i].w, s->tiles[i].h, s->tiles[i].u, s->tiles[i].v);
+               tiles[i].x, tiles[i].y, tiles[i].z, tiles[i].fovx, tiles[i].fovy, tiles[i].w, tiles[i].h, tiles[i].u, tiles[i].v);
     }
 
     return 0;
 }
 
-static int config_input(AVFilterLink *link)
+static inline int align_up(int v, int align)
+{
+    return (v + align - 1) / align * align;
+}
+
+/*
+ * One output per view of the views file, one output holding all views of the
+ * output layout file, or a single view following the head orientation
+ */
+static av_cold int create_outputs(AVFilterContext *ctx)
+{
+    ProjectContext *s = ctx->priv;
+    AVFilterPad pad = { 0 };
+    const char *file = NULL;
+    int i, ret;
+
+    if(strcmp(s->viewsfile, "") && strcmp(s->olofile, "")){
+        av_log(ctx, AV_LOG_ERROR, "[Project Filter] views and olofile cannot be used together\n");
+        return AVERROR(EINVAL);
+    }
+    if(strcmp(s->viewsfile, ""))
+        file = s->viewsfile;
+    else if(strcmp(s->olofile, ""))
+        file = s->olofile;
+
+    s->nb_views = s->nb_targets = 1;
+    if(file){
+        av_log(ctx, AV_LOG_INFO, "[Project Filter] create_outputs(): read views from %s\n", file);
+        if((ret = read_layout(ctx, file, s->view_layout)) ||
+           (ret = parse_tiles(ctx, file, s->view_layout, &s->view_tiles)))
+            return AVERROR(ret);
+        s->nb_views = s->view_layout->nr;
+        if(file == s->viewsfile)
+            s->nb_targets = s->nb_views;
+
+        if(strcmp(s->orfile, "") || strcmp(s->orfeed, "") || s->sidedata)
+            av_log(ctx, AV_LOG_WARNING, "[Project Filter] views keep the rotation of the layout file, the head orientation is ignored\n");
+    }
+
+    s->views = av_mallocz_array(s->nb_views, sizeof(view_t));
+    s->targets = av_mallocz_array(s->nb_targets, sizeof(target_t));
+    s->outs = av_mallocz_array(s->nb_targets, sizeof(AVFrame *));
+    if(!s->views || !s->targets || !s->outs)
+        return AVERROR(ENOMEM);
+
+    for(i = 0; i < s->nb_targets; i++){
+        pad.type = AVMEDIA_TYPE_VIDEO;
+        pad.name = s->nb_targets > 1 || file == s->viewsfile ? av_asprintf("view%d", i) : av_strdup("default");
+        pad.config_props = config_output;
+        pad.request_frame = request_frame;
+        if(!pad.name)
+            return AVERROR(ENOMEM);
+
+        if((ret = ff_insert_outpad(ctx, i, &pad)) < 0){
+            av_freep(&pad.name);
+            return ret;
+        }
+    }
+
+    av_log(ctx, AV_LOG_INFO, "[Project Filter] rendering %d view(s) into %d output(s) per frame\n", s->nb_views, s->nb_targets);
+    return 0;
+}
+
+// planes of the same size and number of channels are grouped into one multiple render target pass
+static void setup_passes(ProjectContext *s, target_t *target)
+{
+    int i = 0;
+
+    target->nb_passes = 0;
+    while(i < s->nb_planes){
+        pass_t *pass = &target->passes[target->nb_passes++];
+        pass->plane = i;
+        pass->nb_planes = 1;
+        pass->w = i ? AV_CEIL_RSHIFT(target->w, s->hsub) : target->w;
+        pass->h = i ? AV_CEIL_RSHIFT(target->h, s->vsub) : target->h;
+        // chroma planes always match each other, luma only without subsampling
+        if(s->mrt)
+            while(i + pass->nb_planes < s->nb_planes &&
+                  s->channels[i + pass->nb_planes] == s->channels[i] &&
+                  (i + pass->nb_planes == 2 || (!s->hsub && !s->vsub)))
+                pass->nb_planes++;
+        pass->program = pass->nb_planes > 1 ? 1 : s->channels[i] > 1 ? 2 : 0;
+        i += pass->nb_planes;
+    }
+}
+
+static av_cold int init_cpu_backend(AVFilterContext *ctx)
+{
+    ProjectContext *s = ctx->priv;
+    int i;
+
+    s->cpu_vertex = -1;
+    for(i = 0; i < NB_CPU_VERTICES; i++)
+        if(!strcmp(s->vshader, cpu_vshaders[i]))
+            s->cpu_vertex = i;
+    if(s->cpu_vertex < 0 || s->shader < 0){
+        av_log(ctx, AV_LOG_ERROR, "[Project Filter] the cpu backend does not implement the vertex/fragment shaders ('%s'/'%s')\n", s->vshader, s->fshader);
+        return AVERROR(ENOSYS);
+    }
+    if(s->pipeline || s->mrt)
+        av_log(ctx, AV_LOG_WARNING, "[Project Filter] pipeline and mrt do not apply to the cpu backend\n");
+    if(s->mipmap != MIPMAP_NONE)
+        av_log(ctx, AV_LOG_WARNING, "[Project Filter] mipmap does not apply to the cpu backend, which samples the input bilinearly\n");
+
+    // projected tiles and the equirectangular shaders follow the head orientation
+    s->lut_rotates = s->cpu_vertex == VERTEX_PERSPECTIVE || s->shader >= SHADER_EQUIRECTANGULAR;
+    ff_project_remap_init(&s->remap);
+
+    return 0;
+}
+
+// 3x3 part of the matrix RotateAboutY(), RotateAboutX() and RotateAboutZ() build in this order, row-major
+static void rotation_matrix(double m[9], double x, double y, double z)
+{
+    Matrix r = IDENTITY_MATRIX;
+    int i, j;
+
+    RotateAboutY(&r, DegreesToRadians(y));
+    RotateAboutX(&r, DegreesToRadians(x));
+    RotateAboutZ(&r, DegreesToRadians(z));
+    for(i = 0; i < 3; i++)
+        for(j = 0; j < 3; j++)
+            m[i * 3 + j] = r.m[i * 4 + j];
+}
+
+// rotationMatrix(radians(vec3(-pitch, yaw+180., roll))) the equirectangular shaders used to build per fragment
+static void erp_rotation_matrix(double m[9], const double rotations[3])
+{
+    rotation_matrix(m, rotations[0], -(rotations[1] + 180), -rotations[2]);
+}
+
+/*
+ * Rotations of a direction of the equirectangular output into the space of
+ * each tile, 9 per tile, row-major: the inverse of rendering the tile as a view
+ * of equirectangular.glsl, whose y and z point the other way than in the tile
+ * space. The output is rotated like such a view is, relative to rotation 0.
+ */
+static void erp_tile_matrices(const ProjectContext *s, const double rotations[3], double *m)
+{
+    static const double origin[3] = { 0 };
+    double e[9], e0[9], r[9], t[3];
+    int i, j, k, n;
+
+    erp_rotation_matrix(e, rotations);
+    erp_rotation_matrix(e0, origin);
+    for(j = 0; j < 3; j++)
+        for(k = 0; k < 3; k++)
+            r[3 * j + k] = e[3 * j] * e0[3 * k] + e[3 * j + 1] * e0[3 * k + 1] + e[3 * j + 2] * e0[3 * k + 2];
+
+    for(n = 0; n < s->layout->nr; n++){
+        t[0] = s->tiles[n].x;
+        t[1] = s->tiles[n].y;
+        t[2] = s->tiles[n].z;
+        erp_rotation_matrix(e, t);
+        for(j = 0; j < 3; j++)
+            for(k = 0; k < 3; k++){
+                m[9 * n + 3 * j + k] = 0;
+                for(i = 0; i < 3; i++)
+                    m[9 * n + 3 * j + k] += e[3 * i + j] * r[3 * i + k];
+                if(j)
+                    m[9 * n + 3 * j + k] *= -1;
+            }
+    }
+}
+
+/*
+ * Find the tile drawn last in the direction of the point fc of an
+ * equirectangular output and its ex_uv there, like toequirectangular.glsl.
+ */
+static const tile_t *cover_direction(const ProjectContext *s, const double *m, const double fc[2], double ex_uv[2])
+{
+    const double d[3] = { pm_erp_x(fc[0], fc[1]), pm_erp_y(fc[0], fc[1]), pm_erp_z(fc[0], fc[1]) };
+    const tile_t *t;
+    double q[3], a, b;
+    int i, j;
+
+    for(i = s->layout->nr - 1; i >= 0; i--){
+        t = &s->tiles[i];
+        for(j = 0; j < 3; j++)
+            q[j] = m[9 * i + 3 * j] * d[0] + m[9 * i + 3 * j + 1] * d[1] + m[9 * i + 3 * j + 2] * d[2];
+        if(q[2] >= 0)
+            continue;
+        a = pm_tile_coord(q[0], q[2], pm_tile_extent(t->fovx));
+        b = pm_tile_coord(q[1], q[2], pm_tile_extent(t->fovy));
+        if(a < 0 || a > 1 || b < 0 || b > 1)
+            continue;
+
+        ex_uv[0] = t->u + a * t->w;
+        ex_uv[1] = t->v + b * t->h;
+        return t;
+    }
+
+    return NULL;
+}
+
+// Same tiles as CreateTiles(), kept for intersecting them with the pixels
+static int create_cpu_tiles(AVFilterContext *ctx)
+{
+    ProjectContext *s = ctx->priv;
+    cpu_tile_t *c;
+    int i, j;
+
+    av_freep(&s->cpu_tiles);
+    if(!(s->cpu_tiles = av_mallocz_array(s->layout->nr, sizeof(cpu_tile_t))))
+        return ENOMEM;
+
+    for(i = 0; i < s->layout->nr; i++){
+        c = &s->cpu_tiles[i];
+        rotation_matrix(c->rot, s->tiles[i].x, s->tiles[i].y, s->tiles[i].z);
+        c->lx = -1 * pm_tile_extent(s->tiles[i].fovx);
+        c->rx = -1 * c->lx;
+        c->ty = pm_tile_extent(s->tiles[i].fovy);
+        c->by = -1 * c->ty;
+
+        for(j = 0; j < 3; j++){
+            c->p0[j] = c->rot[j * 3] * c->lx + c->rot[j * 3 + 1] * c->by - c->rot[j * 3 + 2];
+            c->e1[j] = c->rot[j * 3] * (c->rx - c->lx);
+            c->e2[j] = c->rot[j * 3 + 1] * (c->ty - c->by);
+        }
+
+        c->det = c->e1[0] * c->e2[1] - c->e2[0] * c->e1[1];
+        if(fabs(c->det) < 1e-12)
+            c->det = 0;
+        else{
+            c->inv[0] =  c->e2[1] / c->det;
+            c->inv[1] = -c->e2[0] / c->det;
+            c->inv[2] = -c->e1[1] / c->det;
+            c->inv[3] =  c->e1[0] / c->det;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Find the tile drawn last at the point ndc of the screen and its ex_uv there.
+ * With vertex.glsl the tiles are intersected with the ray d of the pixel, rays
+ * holding the view rotation in the space of each tile; simpleVertex.glsl draws
+ * them straight to the screen.
+ */
+static const tile_t *cover_point(const ProjectContext *s, const double *rays, const double d[3], const double ndc[2], double ex_uv[2])
+{
+    const cpu_tile_t *c;
+    const double *m;
+    double a, b, t, x, y, z;
+    int i;
+
+    for(i = s->layout->nr - 1; i >= 0; i--){
+        c = &s->cpu_tiles[i];
+        if(s->cpu_vertex == VERTEX_PERSPECTIVE){
+            m = rays + 9 * i;
+            z = m[6] * d[0] + m[7] * d[1] + m[8] * d[2];
+            if(z >= 0)
+                continue;
+            // depth of the hit in view space
+            t = -1 / z;
+            if(t < NEAR_PLANE || t > FAR_PLANE)
+                continue;
+            a = ((m[0] * d[0] + m[1] * d[1] + m[2] * d[2]) * t - c->lx) / (c->rx - c->lx);
+            b = ((m[3] * d[0] + m[4] * d[1] + m[5] * d[2]) * t - c->by) / (c->ty - c->by);
+        }else{
+            if(!c->det)
+                continue;
+            x = ndc[0] - c->p0[0];
+            y = ndc[1] - c->p0[1];
+            a = c->inv[0] * x + c->inv[1] * y;
+            b = c->inv[2] * x + c->inv[3] * y;
+            z = c->p0[2] + a * c->e1[2] + b * c->e2[2];
+            if(z < -1 - 1e-6 || z > 1 + 1e-6)
+                continue;
+        }
+        if(a < 0 || a > 1 || b < 0 || b > 1)
+            continue;
+
+        ex_uv[0] = s->tiles[i].u + a * s->tiles[i].w;
+        ex_uv[1] = s->tiles[i].v + b * s->tiles[i].h;
+        return &s->tiles[i];
+    }
+
+    return NULL;
+}
+
+/*
+ * Texture coordinates the fragment shader samples at. Tiles are sampled at
+ * ex_uv of the tile t, an equirectangular input where fc points to. fc is
+ * gl_FragCoord relative to the view and divided by its resolution, erp the
+ * rotation of the equirectangular shaders.
+ */
+static void cpu_sample(const ProjectContext *s, const view_t *view, const double erp[9], const tile_t *t,
+                       const double ex_uv[2], const double fc[2], double st[2])
+{
+    double sc[2], p[3], q[3], norm;
+    int i;
+
+    switch(s->sampling){
+    case SAMPLING_EQDIS:
+    case SAMPLING_EQDEG:
+    case SAMPLING_UNEQDEG:
+        st[0] = pm_tile_sample(s->sampling, ex_uv[0], t->u, t->w / 2, s->in_ecoef);
+        st[1] = pm_tile_sample(s->sampling, ex_uv[1], t->v, t->h / 2, s->in_ecoef);
+        break;
+    default:
+        sc[0] = fc[0] - 0.5;
+        sc[1] = -(fc[1] - 0.5);
+        if(s->shader == SHADER_EQUIRECTANGULAR_EAC){
+            sc[0] = pm_eac_warp(sc[0]);
+            sc[1] = pm_eac_warp(sc[1]);
+        }
+        p[0] = sc[0];
+        p[1] = sc[1];
+        p[2] = 0.5 / tan(0.5 * DegreesToRadians(view->fovx));
+        norm = sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+        for(i = 0; i < 3; i++)
+            q[i] = (erp[i * 3] * p[0] + erp[i * 3 + 1] * p[1] + erp[i * 3 + 2] * p[2]) / norm;
+        st[0] = pm_erp_u(q[0], q[2]);
+        st[1] = pm_erp_v(q[1]);
+        break;
+    }
+}
+
+// Number of pixels in the table of one plane of a target, including the padding of the blocks
+static size_t lut_pixels(const ProjectContext *s, const target_t *target, int plane)
+{
+    const int w = plane ? AV_CEIL_RSHIFT(target->w, s->hsub) : target->w;
+    const int h = plane ? AV_CEIL_RSHIFT(target->h, s->vsub) : target->h;
+
+    return (size_t)FFALIGN(w, LUT_BLOCK_W) * FFALIGN(h, LUT_BLOCK_H);
+}
+
+static size_t lut_element_size(const ProjectContext *s)
+{
+    return s->lut_fixed ? 2 * sizeof(uint16_t) : 2 * sizeof(float);
+}
+
+// Index of the pixel x, y in a table of width w
+static size_t lut_index(int w, int x, int y)
+{
+    const size_t block = (size_t)(y / LUT_BLOCK_H) * ((w + LUT_BLOCK_W - 1) / LUT_BLOCK_W) + x / LUT_BLOCK_W;
+
+    return block * LUT_BLOCK_W * LUT_BLOCK_H + (y % LUT_BLOCK_H) * LUT_BLOCK_W + x % LUT_BLOCK_W;
+}
+
+typedef struct LutThreadData {
+    const view_t *view;
+    const double *rays;     ///< view rotation in the space of each tile, or erp_tile_matrices()
+    double erp[9];          ///< rotation of the equirectangular shaders
+    int plane;
+    void *lut;
+    int lut_w, lut_h;
+} LutThreadData;
+
+// Fill a slice of rows of the table of one plane of the view's target
+static int lut_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    ProjectContext *s = ctx->priv;
+    const LutThreadData *td = arg;
+    const view_t *view = td->view;
+    const int hsub = td->plane ? s->hsub : 0, vsub = td->plane ? s->vsub : 0;
+    const int ox = view->x >> hsub, oy = view->y >> vsub;
+    const int rw = AV_CEIL_RSHIFT(view->w, hsub), rh = AV_CEIL_RSHIFT(view->h, vsub);
+    const int tw = s->tex_w[td->plane], th = s->tex_h[td->plane];
+    const int y_start = FFMAX(oy, 0), y_end = FFMIN(oy + rh, td->lut_h);
+    const int start = y_start + (y_end - y_start) * jobnr / nb_jobs;
+    const int end = y_start + (y_end - y_start) * (jobnr + 1) / nb_jobs;
+    const double tx = pm_tile_extent(view->fovx), ty = pm_tile_extent(view->fovy);
+    double d[3], ndc[2], fc[2], ex_uv[2], st[2], u, v;
+    const tile_t *t;
+    size_t n;
+    int x, y;
+
+    // output row y is framebuffer row y, like in render_target()
+    for(y = start; y < end; y++){
+        fc[1] = (y + 0.5 - oy) / rh;
+        ndc[1] = 2 * fc[1] - 1;
+        for(x = FFMAX(ox, 0); x < FFMIN(ox + rw, td->lut_w); x++){
+            fc[0] = (x + 0.5 - ox) / rw;
+            ndc[0] = 2 * fc[0] - 1;
+            d[0] = ndc[0] * tx;
+            d[1] = ndc[1] * ty;
+            d[2] = -1;
+
+            if(s->shader == SHADER_TO_EQUIRECTANGULAR)
+                t = cover_direction(s, td->rays, fc, ex_uv);
+            else
+                t = cover_point(s, td->rays, d, ndc, ex_uv);
+            if(!t)
+                continue;
+
+            cpu_sample(s, view, td->erp, t, ex_uv, fc, st);
+            u = fmin(fmax(st[0] * tw - 0.5, 0), tw - 1);
+            v = fmin(fmax(st[1] * th - 0.5, 0), th - 1);
+            n = 2 * lut_index(td->lut_w, x, y);
+            if(s->lut_fixed){
+                ((uint16_t *)td->lut)[n] = lrint(u * PROJECT_REMAP_ONE);
+                ((uint16_t *)td->lut)[n + 1] = lrint(v * PROJECT_REMAP_ONE);
+            }else{
+                ((float *)td->lut)[n] = u;
+                ((float *)td->lut)[n + 1] = v;
+            }
+        }
+    }
+
+    return 0;
+}
+
+static void build_view_lut(AVFilterContext *ctx, LutThreadData *td, int plane, void *lut, int lut_w, int lut_h)
+{
+    td->plane = plane;
+    td->lut = lut;
+    td->lut_w = lut_w;
+    td->lut_h = lut_h;
+    ctx->internal->execute(ctx, lut_slice, td, NULL, FFMIN(lut_h, ff_filter_get_nb_threads(ctx)));
+}
+
+static int build_luts(AVFilterContext *ctx, const double rotations[3])
+{
+    ProjectContext *s = ctx->priv;
+    const int64_t start = av_gettime_relative();
+    LutThreadData td;
+    const view_t *view;
+    target_t *target;
+    double view_rotations[3], m[9], *rays;
+    size_t n, size;
+    int i, j, k, p, v;
+
+    if(!(rays = av_malloc_array(s->layout->nr, 9 * sizeof(*rays))))
+        return ENOMEM;
+
+    for(v = 0; v < s->nb_targets; v++){
+        target = &s->targets[v];
+        for(p = 0; p < 2 && target->lut[p]; p++){
+            size = lut_pixels(s, target, p);
+            for(n = 0; n < size; n++){
+                if(s->lut_fixed){
+                    ((uint16_t *)target->lut[p])[2 * n] = PROJECT_REMAP_UNCOVERED;
+                    ((uint16_t *)target->lut[p])[2 * n + 1] = 0;
+                }else{
+                    ((float *)target->lut[p])[2 * n] = -1;
+                    ((float *)target->lut[p])[2 * n + 1] = 0;
+                }
+            }
+        }
+    }
+
+    for(v = 0; v < s->nb_views; v++){
+        view = &s->views[v];
+        target = &s->targets[view->target];
+        if(s->view_tiles){
+            view_rotations[0] = view->xr;
+            view_rotations[1] = view->yr;
+            view_rotations[2] = view->zr;
+        }else
+            memcpy(view_rotations, rotations, sizeof(view_rotations));
+
+        // the view rotation of DrawTiles() brought into the space of each tile
+        rotation_matrix(m, view_rotations[0], view_rotations[1], view_rotations[2]);
+        for(i = 0; i < s->layout->nr; i++)
+            for(j = 0; j < 3; j++)
+                for(k = 0; k < 3; k++)
+                    rays[9 * i + 3 * j + k] = s->cpu_tiles[i].rot[j] * m[k] +
+                                              s->cpu_tiles[i].rot[3 + j] * m[3 + k] +
+                                              s->cpu_tiles[i].rot[6 + j] * m[6 + k];
+        if(s->shader == SHADER_TO_EQUIRECTANGULAR)
+            erp_tile_matrices(s, view_rotations, rays);
+        erp_rotation_matrix(td.erp, view_rotations);
+        td.view = view;
+        td.rays = rays;
+
+        build_view_lut(ctx, &td, 0, target->lut[0], target->w, target->h);
+        if(target->lut[1])
+            build_view_lut(ctx, &td, 1, target->lut[1], AV_CEIL_RSHIFT(target->w, s->hsub), AV_CEIL_RSHIFT(target->h, s->vsub));
+    }
+    av_free(rays);
+
+    memcpy(s->lut_rotations, rotations, sizeof(s->lut_rotations));
+    s->lut_valid = 1;
+    s->nb_lut_builds++;
+    s->lut_time += av_gettime_relative() - start;
+    return 0;
+}
+
+static int alloc_luts(AVFilterContext *ctx)
+{
+    ProjectContext *s = ctx->priv;
+    target_t *target;
+    int v;
+
+    free_luts(s);
+    for(v = 0; v < s->nb_targets; v++){
+        target = &s->targets[v];
+        if(!(target->lut[0] = av_malloc_array(lut_pixels(s, target, 0), lut_element_size(s))))
+            return ENOMEM;
+        // chroma planes of the same size share the luma table
+        if((s->hsub || s->vsub) &&
+           !(target->lut[1] = av_malloc_array(lut_pixels(s, target, 1), lut_element_size(s))))
+            return ENOMEM;
+    }
+
+    return 0;
+}
+
+static void free_luts(ProjectContext *s)
+{
+    int v;
+
+    for(v = 0; s->targets && v < s->nb_targets; v++){
+        if(s->lut_map){
+            s->targets[v].lut[0] = s->targets[v].lut[1] = NULL;
+            continue;
+        }
+        av_freep(&s->targets[v].lut[0]);
+        av_freep(&s->targets[v].lut[1]);
+    }
+    if(s->lut_map)
+        munmap(s->lut_map, s->lut_mapsize);
+    s->lut_map = NULL;
+    s->lut_mapsize = 0;
+    s->lut_valid = 0;
+}
+
+// Size of the tables of all targets in bytes
+static size_t lut_total_size(const ProjectContext *s)
+{
+    size_t size = 0;
+    int v;
+
+    for(v = 0; s->targets && v < s->nb_targets; v++)
+        size += (lut_pixels(s, &s->targets[v], 0) + (s->hsub || s->vsub ? lut_pixels(s, &s->targets[v], 1) : 0)) * lut_element_size(s);
+    return size;
+}
+
+static void sha_update_int(struct AVSHA *sha, int64_t value)
+{
+    uint8_t buf[8];
+
+    AV_WL64(buf, value);
+    av_sha_update(sha, buf, sizeof(buf));
+}
+
+static void sha_update_double(struct AVSHA *sha, double value)
+{
+    sha_update_int(sha, av_double2int(value));
+}
+
+// Hash everything the tables are computed from
+static int lut_cache_key(AVFilterContext *ctx, const double rotations[3], uint8_t key[LUT_KEY_SIZE])
+{
+    ProjectContext *s = ctx->priv;
+    struct AVSHA *sha;
+    const tile_t *t;
+    const view_t *view;
+    int i;
+
+    if(!(sha = av_sha_alloc()))
+        return ENOMEM;
+    av_sha_init(sha, 256);
+
+    av_sha_update(sha, (const uint8_t *)LUT_MAGIC, 8);
+    sha_update_int(sha, LUT_VERSION);
+    sha_update_int(sha, HAVE_BIGENDIAN);
+    sha_update_int(sha, lut_element_size(s));
+    sha_update_int(sha, s->cpu_vertex);
+    sha_update_int(sha, s->shader);
+    sha_update_int(sha, s->lut_fixed);
+    sha_update_int(sha, LUT_BLOCK_W);
+    sha_update_int(sha, LUT_BLOCK_H);
+    sha_update_double(sha, s->ecoef);
+    sha_update_double(sha, s->in_ecoef);
+    sha_update_int(sha, s->sampling);
+    sha_update_int(sha, s->iw);
+    sha_update_int(sha, s->ih);
+    sha_update_int(sha, s->hsub);
+    sha_update_int(sha, s->vsub);
+
+    sha_update_int(sha, s->layout->nr);
+    for(i = 0; i < s->layout->nr; i++){
+        t = &s->tiles[i];
+        sha_update_double(sha, t->x);
+        sha_update_double(sha, t->y);
+        sha_update_double(sha, t->z);
+        sha_update_double(sha, t->fovx);
+        sha_update_double(sha, t->fovy);
+        sha_update_double(sha, t->u);
+        sha_update_double(sha, t->v);
+        sha_update_double(sha, t->w);
+        sha_update_double(sha, t->h);
+    }
+
+    sha_update_int(sha, s->nb_targets);
+    for(i = 0; i < s->nb_targets; i++){
+        sha_update_int(sha, s->targets[i].w);
+        sha_update_int(sha, s->targets[i].h);
+    }
+    sha_update_int(sha, s->nb_views);
+    for(i = 0; i < s->nb_views; i++){
+        view = &s->views[i];
+        sha_update_int(sha, view->target);
+        sha_update_int(sha, view->x);
+        sha_update_int(sha, view->y);
+        sha_update_int(sha, view->w);
+        sha_update_int(sha, view->h);
+        sha_update_double(sha, view->fovx);
+        sha_update_double(sha, view->fovy);
+        sha_update_double(sha, view->xr);
+        sha_update_double(sha, view->yr);
+        sha_update_double(sha, view->zr);
+    }
+
+    // the orientation only matters to tables following it
+    for(i = 0; i < 3; i++)
+        sha_update_double(sha, s->lut_rotates && !s->view_tiles ? rotations[i] : 0);
+
+    av_sha_final(sha, key);
+    av_free(sha);
+    return 0;
+}
+
+static char *lut_cache_path(const ProjectContext *s, const uint8_t key[LUT_KEY_SIZE])
+{
+    char hex[2 * LUT_KEY_SIZE + 1];
+    int i;
+
+    for(i = 0; i < LUT_KEY_SIZE; i++)
+        snprintf(hex + 2 * i, 3, "%02x", key[i]);
+    return av_asprintf("%s/%s.lut", s->cachedir, hex);
+}
+
+// Map the tables from the cache, returns 0 on a hit
+static int load_lut_cache(AVFilterContext *ctx, const char *path, const uint8_t key[LUT_KEY_SIZE])
+{
+    ProjectContext *s = ctx->priv;
+    const size_t size = lut_total_size(s);
+    struct stat st;
+    uint8_t *map, *lut;
+    int fd, v;
+
+    if((fd = open(path, O_RDONLY)) < 0)
+        return ENOENT;
+    if(fstat(fd, &st) || st.st_size != LUT_HEADER_SIZE + size){
+        av_log(ctx, AV_LOG_WARNING, "[Project Filter] load_lut_cache(): %s has an unexpected size, rebuilding it\n", path);
+        close(fd);
+        return EINVAL;
+    }
+    // shared, read-only pages: concurrent processes use the same physical memory
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(map == MAP_FAILED){
+        av_log(ctx, AV_LOG_WARNING, "[Project Filter] load_lut_cache(): Failed to map %s\n", path);
+        return EIO;
+    }
+    if(memcmp(map, LUT_MAGIC, 8) || memcmp(map + 8, key, LUT_KEY_SIZE) || AV_RL64(map + 8 + LUT_KEY_SIZE) != size){
+        av_log(ctx, AV_LOG_WARNING, "[Project Filter] load_lut_cache(): %s is corrupt, rebuilding it\n", path);
+        munmap(map, st.st_size);
+        return EINVAL;
+    }
+
+    free_luts(s);
+    s->lut_map = map;
+    s->lut_mapsize = st.st_size;
+    lut = map + LUT_HEADER_SIZE;
+    for(v = 0; v < s->nb_targets; v++){
+        s->targets[v].lut[0] = lut;
+        lut += lut_pixels(s, &s->targets[v], 0) * lut_element_size(s);
+        if(s->hsub || s->vsub){
+            s->targets[v].lut[1] = lut;
+            lut += lut_pixels(s, &s->targets[v], 1) * lut_element_size(s);
+        }
+    }
+    return 0;
+}
+
+// Store the tables in the cache; written to a temporary file and renamed, so readers never see a partial file
+static void save_lut_cache(AVFilterContext *ctx, const char *path, const uint8_t key[LUT_KEY_SIZE])
+{
+    ProjectContext *s = ctx->priv;
+    uint8_t header[LUT_HEADER_SIZE] = { 0 };
+    char *tmp;
+    FILE *fp;
+    int fd, p, v, ok;
+
+    if(!(tmp = av_asprintf("%s.XXXXXX", path)))
+        return;
+    if((fd = mkstemp(tmp)) < 0 || !(fp = fdopen(fd, "wb"))){
+        av_log(ctx, AV_LOG_WARNING, "[Project Filter] save_lut_cache(): Failed to create %s\n", tmp);
+        if(fd >= 0){
+            close(fd);
+            unlink(tmp);
+        }
+        av_free(tmp);
+        return;
+    }
+    fchmod(fd, 0644);
+
+    memcpy(header, LUT_MAGIC, 8);
+    memcpy(header + 8, key, LUT_KEY_SIZE);
+    AV_WL64(header + 8 + LUT_KEY_SIZE, lut_total_size(s));
+    ok = fwrite(header, sizeof(header), 1, fp) == 1;
+    for(v = 0; v < s->nb_targets; v++)
+        for(p = 0; p < 2 && s->targets[v].lut[p]; p++)
+            ok &= fwrite(s->targets[v].lut[p], lut_element_size(s), lut_pixels(s, &s->targets[v], p), fp) == lut_pixels(s, &s->targets[v], p);
+    ok &= !fclose(fp);
+
+    if(!ok || rename(tmp, path)){
+        av_log(ctx, AV_LOG_WARNING, "[Project Filter] save_lut_cache(): Failed to write %s\n", path);
+        unlink(tmp);
+    }else
+        av_log(ctx, AV_LOG_INFO, "[Project Filter] save_lut_cache(): Stored remap tables in %s\n", path);
+    av_free(tmp);
+}
+
+// Build the tables for the orientation, or map them from the cache directory when they are built for a new input
+static int update_luts(AVFilterContext *ctx, const double rotations[3])
+{
+    ProjectContext *s = ctx->priv;
+    const int cache = !s->lut_valid && strcmp(s->cachedir, "");
+    uint8_t key[LUT_KEY_SIZE];
+    char *path = NULL;
+    int ret;
+
+    // mapped tables are read-only
+    if(s->lut_map && (ret = alloc_luts(ctx)))
+        return ret;
+
+    if(cache){
+        if(ret = lut_cache_key(ctx, rotations, key))
+            return ret;
+        if(!(path = lut_cache_path(s, key)))
+            return ENOMEM;
+        if(!load_lut_cache(ctx, path, key)){
+            av_log(ctx, AV_LOG_INFO, "[Project Filter] update_luts(): Mapped remap tables from %s\n", path);
+            memcpy(s->lut_rotations, rotations, sizeof(s->lut_rotations));
+            s->lut_valid = 1;
+            s->nb_lut_loads++;
+            av_free(path);
+            return 0;
+        }
+    }
+
+    if(!(ret = build_luts(ctx, rotations)) && cache)
+        save_lut_cache(ctx, path, key);
+    av_free(path);
+    return ret;
+}
+
+// Whether PROJECT_REMAP_PADDING bytes past the end of the plane's rows can be read
+static int plane_padded(AVFrame *frame, int plane, int w, int h)
+{
+    AVBufferRef *buf = av_frame_get_plane_buffer(frame, plane);
+    const uint8_t *last;
+
+    if(!buf)
+        return 0;
+    last = frame->linesize[plane] < 0 ? frame->data[plane] : frame->data[plane] + (ptrdiff_t)(h - 1) * frame->linesize[plane];
+    return last + w + PROJECT_REMAP_PADDING <= buf->data + buf->size;
+}
+
+typedef struct ThreadData {
+    AVFrame *in, *out;
+    const target_t *target;
+} ThreadData;
+
+// Remap a slice of block rows of every plane of a target, block by block
+static int remap_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    ProjectContext *s = ctx->priv;
+    const ThreadData *td = arg;
+    const target_t *target = td->target;
+    AVFrame *in = td->in, *out = td->out;
+    const size_t elem = lut_element_size(s);
+    project_remap_line_fn remap_line;
+    project_remap_line_fixed_fn remap_line_fixed;
+    const uint8_t *lut, *block;
+    int p, y, w, h, bx, by, bw, start, end;
+
+    for(p = 0; p < s->nb_planes; p++){
+        lut = p && target->lut[1] ? target->lut[1] : target->lut[0];
+        w = p ? AV_CEIL_RSHIFT(target->w, s->hsub) : target->w;
+        h = p ? AV_CEIL_RSHIFT(target->h, s->vsub) : target->h;
+        start = (h + LUT_BLOCK_H - 1) / LUT_BLOCK_H * jobnr / nb_jobs;
+        end = (h + LUT_BLOCK_H - 1) / LUT_BLOCK_H * (jobnr + 1) / nb_jobs;
+        if(plane_padded(in, p, s->tex_w[p], s->tex_h[p])){
+            remap_line = s->remap.remap_line_padded;
+            remap_line_fixed = s->remap.remap_line_fixed_padded;
+        }else{
+            remap_line = s->remap.remap_line;
+            remap_line_fixed = s->remap.remap_line_fixed;
+        }
+
+        for(by = start; by < end; by++){
+            for(bx = 0; bx < w; bx += LUT_BLOCK_W){
+                bw = FFMIN(LUT_BLOCK_W, w - bx);
+                block = lut + lut_index(w, bx, by * LUT_BLOCK_H) * elem;
+                for(y = by * LUT_BLOCK_H; y < FFMIN((by + 1) * LUT_BLOCK_H, h); y++, block += LUT_BLOCK_W * elem){
+                    if(s->lut_fixed)
+                        remap_line_fixed(out->data[p] + y * out->linesize[p] + bx, in->data[p], in->linesize[p],
+                                         (const uint16_t *)block, bw, s->tex_w[p], s->tex_h[p]);
+                    else
+                        remap_line(out->data[p] + y * out->linesize[p] + bx, in->data[p], in->linesize[p],
+                                   (const float *)block, bw, s->tex_w[p], s->tex_h[p]);
+                }
+            }
+        }
+    }
+
+    if(out->data[3]){
+        start = out->height * jobnr / nb_jobs;
+        end = out->height * (jobnr + 1) / nb_jobs;
+        memset(out->data[3] + start * out->linesize[3], 255, (end - start) * out->linesize[3]);
+    }
+
+    return 0;
+}
+
+// Textures and framebuffers keep their storage for the whole stream
+static int create_gl_resources(AVFilterContext *ctx)
+{
+    ProjectContext *s = ctx->priv;
+    target_t *target;
+    int i, v, ret;
+
+    DestroyTexture(ctx);
+    DestroyFramebuffer(ctx);
+    for(i = 0; i < s->nb_planes; i++)
+        if(ret = CreateTexutre(ctx, i, i ? AV_CEIL_RSHIFT(s->iw, s->hsub) : s->iw, i ? AV_CEIL_RSHIFT(s->ih, s->vsub) : s->ih))
+            return ret;
+    for(v = 0; v < s->nb_targets; v++){
+        target = &s->targets[v];
+        for(i = 0; i < s->nb_planes; i++)
+            if(ret = CreateRenderbuffer(ctx, target, i, i ? AV_CEIL_RSHIFT(target->w, s->hsub) : target->w, i ? AV_CEIL_RSHIFT(target->h, s->vsub) : target->h))
+                return ret;
+        for(i = 0; i < target->nb_passes; i++)
+            if(ret = CreateFramebuffer(ctx, target, i))
+                return ret;
+    }
+
+    return CreateReadbacks(ctx);
+}
+
+static int create_cpu_resources(AVFilterContext *ctx)
+{
+    ProjectContext *s = ctx->priv;
+    int i;
+
+    for(i = 0; i < 3; i++){
+        s->tex_w[i] = i ? AV_CEIL_RSHIFT(s->iw, s->hsub) : s->iw;
+        s->tex_h[i] = i ? AV_CEIL_RSHIFT(s->ih, s->vsub) : s->ih;
+    }
+    if(s->tex_w[1] < 2 || s->tex_h[1] < 2){
+        av_log(ctx, AV_LOG_ERROR, "[Project Filter] the cpu backend needs input planes of at least 2x2 pixels\n");
+        return EINVAL;
+    }
+
+    s->lut_fixed = s->lutfmt == LUT_FIXED;
+    if(s->lut_fixed && (s->iw > PROJECT_REMAP_FIXED_MAX || s->ih > PROJECT_REMAP_FIXED_MAX)){
+        av_log(ctx, AV_LOG_WARNING, "[Project Filter] %dx%d input is too large for fixed-point tables, using float ones\n", s->iw, s->ih);
+        s->lut_fixed = 0;
+    }
+
+    return alloc_luts(ctx);
+}
+
+static int configure_input(AVFilterLink *link)
 {
     AVFilterContext *ctx = link->dst;
     ProjectContext *s = ctx->priv;
     const AVPixFmtDescriptor *pix_desc = av_pix_fmt_desc_get(link->format);
-    int ret, i;
+    int ret;
     const char *expr;
     double res;
-    size_t bufsize;
     double fovx, fovy;
+    view_t *view;
+    target_t *target;
+    int i, v;
 
     av_log(ctx, AV_LOG_INFO, "[Project Filter] Configuring input parameters...\n");
 
@@ -564,6 +2148,41 @@ static int config_input(AVFilterLink *link)
     s->hsub = pix_desc->log2_chroma_w;
     s->vsub = pix_desc->log2_chroma_h;
 
+    // high bit depth samples are normalized to the full 16-bit range and back, keeping their values
+    s->bytes = (pix_desc->comp[0].depth + 7) >> 3;
+    s->PixelType = s->bytes > 1 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_BYTE;
+
+    // the chroma components of semi-planar formats share one plane, packed RGB has a single one
+    s->nb_planes = FFMIN(av_pix_fmt_count_planes(link->format), 3);
+    for(i = 0; i < 3; i++){
+        s->channels[i] = i < s->nb_planes ? s->max_step[i] / s->bytes : 1;
+        switch(s->channels[i]){
+        case 1:
+            s->InternalFormats[i] = s->bytes > 1 ? GL_R16 : GL_R8;
+            s->PixelFormats[i] = GL_RED;
+            break;
+        case 2:
+            s->InternalFormats[i] = s->bytes > 1 ? GL_RG16 : GL_RG8;
+            s->PixelFormats[i] = GL_RG;
+            break;
+        default:
+            // RGB24 goes through RGBA textures and render buffers too
+            s->InternalFormats[i] = GL_RGBA8;
+            s->PixelFormats[i] = s->channels[i] == 3 ? GL_RGB : GL_RGBA;
+            break;
+        }
+        memcpy(s->clear_colors[i], back_color, sizeof(back_color));
+    }
+
+    // the bytes of packed pixels are the channels as they are: the alpha or padding
+    // byte, wherever it is, is the one not holding R, G or B
+    if(s->channels[0] == 4){
+        memset(s->clear_colors[0], 0, sizeof(s->clear_colors[0]));
+        for(i = 0; i < 4; i++)
+            if(i != pix_desc->comp[0].offset && i != pix_desc->comp[1].offset && i != pix_desc->comp[2].offset)
+                s->clear_colors[0][i] = 1.0f;
+    }
+
     normalize_double(&s->iw, s->var_values[VAR_IN_W]);
     normalize_double(&s->ih, s->var_values[VAR_IN_H]);
 
@@ -634,77 +2253,264 @@ static int config_input(AVFilterLink *link)
         s->y &= ~((1 << s->vsub) - 1);
     }
 
-    if(s->ecoef != 1.0f){
-        fovx = s->fovx;
-        fovy = s->fovy;
-        s->fovx = RadiansToDegrees( atan2( tan(DegreesToRadians(s->fovx / 2.0)) * s->ecoef, 1.0 ) ) * 2;
-        s->fovy = RadiansToDegrees( atan2( tan(DegreesToRadians(s->fovy / 2.0)) * s->ecoef, 1.0 ) )* 2;
-        av_log(ctx, AV_LOG_INFO, "[Project Filter] expand fovx, fovy from %.2f, %.2f to %.2f, %.2f with expand coefficient %.2f\n", fovx, fovy, s->fovx, s->fovy, s->ecoef);
+    for(v = 0; v < s->nb_views; v++){
+        view = &s->views[v];
+        if(s->view_tiles){
+            // like the tiles of a layout, views are placed and sized relative to out_w x out_h
+            const tile_t *t = &s->view_tiles[v];
+            view->target = s->nb_targets > 1 ? v : 0;
+            view->x = s->nb_targets > 1 ? 0 : align_up(t->u * s->w, s->align);
+            view->y = s->nb_targets > 1 ? 0 : align_up(t->v * s->h, s->align);
+            view->w = align_up(t->w * s->w, s->align);
+            view->h = align_up(t->h * s->h, s->align);
+            view->fovx = t->fovx;
+            view->fovy = t->fovy;
+            view->xr = t->x;
+            view->yr = t->y;
+            view->zr = t->z;
+        }else{
+            view->w = s->w;
+            view->h = s->h;
+            view->fovx = s->fovx;
+            view->fovy = s->fovy;
+        }
+
+        if(s->ecoef != 1.0f){
+            fovx = view->fovx;
+            fovy = view->fovy;
+            view->fovx = RadiansToDegrees( atan2( tan(DegreesToRadians(fovx / 2.0)) * s->ecoef, 1.0 ) ) * 2;
+            view->fovy = RadiansToDegrees( atan2( tan(DegreesToRadians(fovy / 2.0)) * s->ecoef, 1.0 ) )* 2;
+            av_log(ctx, AV_LOG_INFO, "[Project Filter] expand fovx, fovy from %.2f, %.2f to %.2f, %.2f with expand coefficient %.2f\n", fovx, fovy, view->fovx, view->fovy, s->ecoef);
+        }
+
+        av_log(ctx, AV_LOG_INFO, "[Project Filter] view %d: %dx%d at %d,%d of output %d\n", v, view->w, view->h, view->x, view->y, view->target);
+    }
+
+    // a single target holds the whole output layout, separate views get a target of their own size
+    for(v = 0; v < s->nb_targets; v++){
+        target = &s->targets[v];
+        target->w = s->nb_targets > 1 ? s->views[v].w : s->w;
+        target->h = s->nb_targets > 1 ? s->views[v].h : s->h;
+        // configure the width and height of framebuffer
+        av_log(ctx, AV_LOG_INFO, "[Project Filter] configure the framebuffer width and height of output %d as %d and %d\n", v, target->w, target->h);
+        setup_passes(s, target);
+    }
+    av_log(ctx, AV_LOG_INFO, "[Project Filter] rendering %d plane(s) with %d pass(es) per output\n", s->nb_planes, s->targets[0].nb_passes);
+
+    if(ret = s->backend == BACKEND_CPU ? create_cpu_resources(ctx) : create_gl_resources(ctx))
+        return AVERROR(ret);
+
+    // load orientation file
+    if((ret = load_orfile(ctx)) < 0)
+        return ret;
+
+    // a reconfiguration rebuilds the tiles and their GL objects from scratch
+    if(s->backend == BACKEND_GL)
+        DestroyCube(ctx);
+    free(s->tiles);
+    free(s->vertices);
+    s->tiles = NULL;
+    s->vertices = NULL;
+    s->layout->nr = 0;
+
+    // load from layout file or the default cubic layout
+    if(ret = load_lofile(ctx))
+        return AVERROR(ret);
+
+    // parse the tile layout
+    if(ret = parse_tiles(ctx, s->lofile, s->layout, &s->tiles))
+        return AVERROR(ret);
+
+    if(ret = s->backend == BACKEND_CPU ? create_cpu_tiles(ctx) : CreateTiles(ctx))
+        return AVERROR(ret);
+
+    return 0;
+
+fail_expr:
+    av_log(NULL, AV_LOG_ERROR, "Error when evaluating the expression '%s'\n", expr);
+    return ret;
+}
+
+static int config_input(AVFilterLink *link)
+{
+    AVFilterContext *ctx = link->dst;
+    ProjectContext *s = ctx->priv;
+    int ret;
+
+    if(s->backend == BACKEND_CPU)
+        return configure_input(link);
+
+    if(!s->gl_ready){
+        av_log(ctx, AV_LOG_INFO, "[Project Filter] Initialize OpenGL context\n");
+        if(gl_init(ctx))
+            return AVERROR(ENOSYS);
+    }
+
+    LockGLContext();
+    ret = configure_input(link);
+    UnlockGLContext();
+
+    return ret;
+}
+
+static int config_output(AVFilterLink *link)
+{
+    AVFilterContext *ctx = link->src;
+    ProjectContext *s = link->src->priv;
+    const AVPixFmtDescriptor *pix_desc = av_pix_fmt_desc_get(link->format);
+    const target_t *target = &s->targets[FF_OUTLINK_IDX(link)];
+
+    av_log(link->src, AV_LOG_INFO, "[Project Filter] Entrance of config_output\n");
+
+    av_log(ctx, AV_LOG_INFO, "[Project Filter] pixel format: %s\n", pix_desc->alias);
+    printPixelFormat(ctx, pix_desc);
+
+    link->w = target->w;
+    link->h = target->h;
+    link->sample_aspect_ratio = s->out_sar;
+
+    return 0;
+}
+
+static void free_outs(ProjectContext *s)
+{
+    int v;
+
+    for(v = 0; v < s->nb_targets; v++)
+        av_frame_free(&s->outs[v]);
+}
+
+// Output frames of the current input frame, one per target
+static int get_outs(AVFilterContext *ctx, const AVFrame *frame)
+{
+    ProjectContext *s = ctx->priv;
+    AVFilterLink *outlink;
+    int v;
+
+    for(v = 0; v < s->nb_targets; v++){
+        outlink = ctx->outputs[v];
+        s->outs[v] = ff_get_video_buffer(outlink, outlink->w, outlink->h);
+        if(!s->outs[v]){
+            free_outs(s);
+            return AVERROR(ENOMEM);
+        }
+        av_frame_copy_props(s->outs[v], frame);
+    }
+
+    return 0;
+}
+
+static int send_outs(AVFilterContext *ctx)
+{
+    ProjectContext *s = ctx->priv;
+    int v, ret;
+
+    for(v = 0; v < s->nb_targets; v++){
+        ret = ff_filter_frame(ctx->outputs[v], s->outs[v]);
+        s->outs[v] = NULL;
+        if(ret < 0){
+            free_outs(s);
+            return ret;
+        }
     }
 
-    // configure the width and height of framebuffer
-    av_log(ctx, AV_LOG_INFO, "[Project Filter] configure the framebuffer width and height as %d and %d\n", s->w, s->h);
-    /* CreateFramebuffer(ctx, s->w, s->h); */
-    /* CreateFramebuffer2(ctx, (s->w >> s->hsub), (s->h >> s->vsub)); */
-    glGenFramebuffers(1, &s->FramebufferId);
-    glGenRenderbuffers(1, &s->RenderbufferId);
-    glGenFramebuffers(1, &s->FramebufferId2);
-    glGenRenderbuffers(1, &s->RenderbufferId2);
+    return 0;
+}
 
+// y, u and v planes, several of them at once with multiple render targets,
+// of all views in the target
+static int render_target(AVFilterContext *ctx, int t, AVFrame *out, double rotations[3])
+{
+    ProjectContext *s = ctx->priv;
+    const target_t *target = &s->targets[t];
+    double view_rotations[3];
+    int i, j, v, ret;
 
+    for(i = 0; i < target->nb_passes; i++){
+        const pass_t *pass = &target->passes[i];
+        const int hsub = pass->plane ? s->hsub : 0, vsub = pass->plane ? s->vsub : 0;
 
-    for(i = 0; i < 3; i++){
-        bufsize = sizeof(uint8_t);
-        if(i == 0){
-            bufsize *= s->iw;
-            bufsize *= s->ih;
-        }else{
-            bufsize *= (s->iw >> s->hsub);
-            bufsize *= (s->ih >> s->vsub);
+        for(j = 0; j < pass->nb_planes; j++){
+            glActiveTexture(GL_TEXTURE0 + j);
+            glBindTexture(GL_TEXTURE_2D, s->TextureIds[pass->plane + j]);
         }
-        if(s->ori_buffer[i] != NULL)
-            free(s->ori_buffer[i]);
-        s->ori_buffer[i] = malloc(bufsize);
-    }
 
-    // load orientation file
-    if(ret = load_orfile(ctx))
-        return AVERROR(ret);
+        glBindFramebuffer(GL_FRAMEBUFFER, target->FramebufferIds[i]);
+        ExitOnGLError(ctx, "ERROR: Could not bind frame buffer");
+        for(j = 0; j < pass->nb_planes; j++)
+            glClearBufferfv(GL_COLOR, j, s->clear_colors[pass->plane + j]);
+        ExitOnGLError(ctx, "ERROR: Could not clear frame buffer");
+
+        // output row r is framebuffer row r, so the top-down view rectangle maps directly
+        glEnable(GL_SCISSOR_TEST);
+        for(v = 0; v < s->nb_views; v++){
+            const view_t *view = &s->views[v];
+            const GLfloat origin[2] = { view->x >> hsub, view->y >> vsub };
+            const GLfloat res[2] = { AV_CEIL_RSHIFT(view->w, hsub), AV_CEIL_RSHIFT(view->h, vsub) };
+
+            if(view->target != t)
+                continue;
+
+            if(s->view_tiles){
+                view_rotations[0] = view->xr;
+                view_rotations[1] = view->yr;
+                view_rotations[2] = view->zr;
+            }else
+                memcpy(view_rotations, rotations, sizeof(view_rotations));
+
+            glViewport(origin[0], origin[1], res[0], res[1]);
+            glScissor(origin[0], origin[1], res[0], res[1]);
+            if(ret = DrawTiles(ctx, &s->programs[pass->program], view, view_rotations, res, origin)){
+                glDisable(GL_SCISSOR_TEST);
+                return ret;
+            }
+        }
+        glDisable(GL_SCISSOR_TEST);
 
-    // load from layout file or the default cubic layout
-    if(ret = load_lofile(ctx))
-        return AVERROR(ret);
+        for(j = 0; j < pass->nb_planes; j++){
+            glReadBuffer(GL_COLOR_ATTACHMENT0 + j);
+            ExitOnGLError(ctx, "ERROR: Could not read buffer");
 
-    // parse the tile layout
-    if(ret = parse_tiles(ctx))
-        return AVERROR(ret);
+            ReadPlane(ctx, target, out, pass->plane + j, pass->w, pass->h);
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
 
-    if(ret = CreateTiles(ctx))
-        return AVERROR(ret);
+    if(out->data[3])
+        memset(out->data[3], 255, out->height * out->linesize[3]);
 
     return 0;
-
-fail_expr:
-    av_log(NULL, AV_LOG_ERROR, "Error when evaluating the expression '%s'\n", expr);
-    return ret;
 }
 
-static int config_output(AVFilterLink *link)
+// The tables are only rebuilt when the orientation they depend on changes
+static int filter_frame_cpu(AVFilterContext *ctx, AVFrame *frame, double rotations[3])
 {
-    AVFilterContext *ctx = link->src;
-    ProjectContext *s = link->src->priv;
-    const AVPixFmtDescriptor *pix_desc = av_pix_fmt_desc_get(link->format);
+    ProjectContext *s = ctx->priv;
+    int64_t start;
+    int v, ret;
 
-    av_log(link->src, AV_LOG_INFO, "[Project Filter] Entrance of config_output\n");
+    if((!s->lut_valid || (s->lut_rotates && !s->view_tiles && memcmp(rotations, s->lut_rotations, sizeof(s->lut_rotations)))) &&
+       (ret = update_luts(ctx, rotations))){
+        av_frame_free(&frame);
+        return AVERROR(ret);
+    }
 
-    av_log(ctx, AV_LOG_INFO, "[Project Filter] pixel format: %s\n", pix_desc->alias);
-    printPixelFormat(ctx, pix_desc);
+    ret = get_outs(ctx, frame);
+    if(ret < 0){
+        av_frame_free(&frame);
+        return ret;
+    }
 
-    link->w = s->w;
-    link->h = s->h;
-    link->sample_aspect_ratio = s->out_sar;
+    start = av_gettime_relative();
+    for(v = 0; v < s->nb_targets; v++){
+        ThreadData td = { .in = frame, .out = s->outs[v], .target = &s->targets[v] };
+        ctx->internal->execute(ctx, remap_slice, &td, NULL, FFMIN((s->targets[v].h + LUT_BLOCK_H - 1) / LUT_BLOCK_H, ff_filter_get_nb_threads(ctx)));
+    }
+    s->remap_time += av_gettime_relative() - start;
+    s->nb_remapped++;
+    av_frame_free(&frame);
 
-    return 0;
+    return send_outs(ctx);
 }
 
 static int filter_frame(AVFilterLink *link, AVFrame *frame)
@@ -713,52 +2519,28 @@ static int filter_frame(AVFilterLink *link, AVFrame *frame)
     ProjectContext *s = ctx->priv;
     const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(link->format);
     int ret;
-    int i;
-    int j;
-    int in_w, in_h;
-    static int fr_idx = 0;
+    int i, j, v;
     // time in sec
-    double fr_t, args[4], rotations[3];
-    int parsed;
-    char line[128];
-    const GLfloat res[2] = { s->w, s->h };
-    const GLfloat res2[2] = { s->w >> s->hsub, s->h >> s->vsub };
+    double fr_t, rotations[3];
 
 
-    fr_idx++;
-    if(fr_idx == 1)
-        av_log(ctx, AV_LOG_INFO, "[Project Filter] filter_frame(): frame %d\n", fr_idx);
+    s->fr_idx++;
+    if(s->fr_idx == 1)
+        av_log(ctx, AV_LOG_INFO, "[Project Filter] filter_frame(): frame %d\n", s->fr_idx);
 
     fr_t = frame->pts == AV_NOPTS_VALUE ? NAN : frame->pts * av_q2d(link->time_base);
-    if(fr_idx == 1)
-        av_log(ctx, AV_LOG_INFO, "[Project Filter] filter_frame(): frame: %d, pts: %lld, timestamp: %lld, time: %f, timebase: %f\n", fr_idx, frame->pts, frame->best_effort_timestamp, fr_t, s->tb);
+    if(s->fr_idx == 1)
+        av_log(ctx, AV_LOG_INFO, "[Project Filter] filter_frame(): frame: %d, pts: %lld, timestamp: %lld, time: %f, timebase: %f\n", s->fr_idx, frame->pts, frame->best_effort_timestamp, fr_t, s->tb);
 
     rotations[0] = s->xr;
     rotations[1] = s->yr;
     rotations[2] = s->zr;
 
-    if(s->ors->nr > 0){
-        for(i = 0; i < s->ors->nr; i++){
-            memcpy(line, s->ors->head[i].str, 128);
-            parsed = parseArgsf(line, args, " ");
-            if(parsed != 4){
-                av_log(ctx, AV_LOG_ERROR, "[Project Filter] Error on parsing file %s line %d: %s\n", s->orfile, i+1, s->ors->head[i].str);
-                return AVERROR(ENOSYS);
-            }
-
-            if(args[0] > fr_t + s->tb)
-                break;
-            rotations[0] = args[2];
-            rotations[1] = args[3];
-            rotations[2] = 0.0f;
-        }
-    }
-
-    in_w = frame->width;
-    in_h = frame->height;
-
-    frame->width  = s->w;
-    frame->height = s->h;
+    // frame side data > live feed, once it has sent a pose > orientation file > rotation options
+    if(!s->feed_running || !read_pose(&s->pose, rotations))
+        lookup_orientation(ctx, fr_t + s->tb, rotations);
+    if(s->sidedata)
+        frame_orientation(ctx, frame, rotations);
 
     s->var_values[VAR_N] = link->frame_count_out;
     s->var_values[VAR_T] = frame->pts == AV_NOPTS_VALUE ?
@@ -806,130 +2588,70 @@ static int filter_frame(AVFilterLink *link, AVFrame *frame)
     }
 
 
-    if(fr_idx == 1)
+    if(s->fr_idx == 1)
         av_log(ctx, AV_LOG_INFO, "[Project Filter] s->iw: %d, s->ih: %d, s->hsub: %d, s->vsub: %d, frame->linesize[0]: %d, frame->linesize[1]: %d, frame->linesize[2]: %d\n",
                s->iw, s->ih, s->hsub, s->vsub, frame->linesize[0], frame->linesize[1], frame->linesize[2]);
 
-    for(i = 0; i < 3; i++){
-        if(i == 0){
-            if(fr_idx == 1)
-                av_log(ctx, AV_LOG_INFO, "[Project Filter] copy data to %p with size %lu, from %p with size %d\n",
-                       s->ori_buffer[i], sizeof(uint8_t) * s->iw * s->ih,
-                       frame->data[i], frame->linesize[i] * in_h
-                );
-            for (j = 0; j < s->ih; j++) {
-                memcpy(s->ori_buffer[i] + j * s->iw, frame->data[i] + j * frame->linesize[0],
-                           sizeof(uint8_t) * s->iw);
-            }
-        }else{
-            if(fr_idx == 1)
-                av_log(ctx, AV_LOG_INFO, "[Project Filter] copy data to %p with size %lu, from %p with size %d\n",
-                   s->ori_buffer[i], sizeof(uint8_t) * (s->iw >> s->hsub) * (s->ih >> s->vsub),
-                   frame->data[i], frame->linesize[i] * (in_h >> s->vsub)
-                );
-            for (j = 0; j < (s->ih >> s->vsub); j++) {
-                memcpy(s->ori_buffer[i] + j * (s->iw >> s->hsub),
-                       frame->data[i] + j * frame->linesize[i],
-                       sizeof(uint8_t) * (s->iw >> s->hsub));
-            }
-        }
-    }
-
-
-    glViewport(0, 0, s->w, s->h);
-
-    LoadTexture(ctx, in_w, in_h, s->ori_buffer[0]);
-    glBindTexture(GL_TEXTURE_2D, s->TextureId);
+    if(s->backend == BACKEND_CPU)
+        return filter_frame_cpu(ctx, frame, rotations);
 
+    LockGLContext();
+    for(i = 0; i < s->nb_planes; i++)
+        LoadTexture(ctx, i, frame->linesize[i], frame->data[i]);
 
-    CreateFramebuffer(ctx, s->w, s->h);
-    glBindFramebuffer(GL_FRAMEBUFFER, s->FramebufferId);
-    ExitOnGLError(ctx, "ERROR: Could not bind frame buffer");
-    glDrawBuffers(1, draw_buffers);
-    glClearBufferfv(GL_COLOR, 0, back_color);
-    ExitOnGLError(ctx, "ERROR: Could not setup clear buffer");
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
-    ExitOnGLError(ctx, "ERROR: Could not clear frame buffer");
-
-    if(ret = DrawTiles(ctx, rotations, res))
-        return AVERROR(ret);
-
-    glReadBuffer(GL_COLOR_ATTACHMENT0);
-    ExitOnGLError(ctx, "ERROR: Could not read buffer");
-
-    frame->width = s->w;
-    frame->height = s->h;
-    frame->linesize[0] = s->w;
-    frame->linesize[1] = s->w >> s->vsub;
-    frame->linesize[2] = s->w >> s->vsub;
-
-    av_frame_get_buffer(frame, 1);
+    // the planes now live in the textures, the input can go back to its pool
+    ret = get_outs(ctx, frame);
+    av_frame_free(&frame);
+    if(ret < 0){
+        UnlockGLContext();
+        return ret;
+    }
 
-    if(fr_idx == 1)
+    if(s->fr_idx == 1)
       av_log(ctx, AV_LOG_INFO, "[Project Filter] parameters: s->max_step: %d, %d, %d, linesize: %d, %d, %d, w/h: %d, %d, hsub/vsub: %d, %d\n",
-             s->max_step[0], s->max_step[1], s->max_step[2], frame->linesize[0], frame->linesize[1], frame->linesize[2],
-             s->w, s->h, s->vsub, s->hsub);
-
-    glReadPixels(0, 0, s->w, s->h, GL_RED, GL_UNSIGNED_BYTE, frame->data[0]);
-    ExitOnGLError(ctx, "ERROR: Could not read pixel");
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-    // u plane
-    glViewport(0, 0, s->w >> s->hsub, s->h >> s->vsub);
-
-    LoadTexture(ctx, in_w >> s->hsub, in_h >> s->vsub, s->ori_buffer[1]);
-    glBindTexture(GL_TEXTURE_2D, s->TextureId);
-
-    CreateFramebuffer2(ctx, (s->w >> s->hsub), (s->h >> s->vsub));
-    glBindFramebuffer(GL_FRAMEBUFFER, s->FramebufferId2);
-    ExitOnGLError(ctx, "ERROR: Could not bind frame buffer 2");
-    glDrawBuffers(1, draw_buffers);
-    glClearBufferfv(GL_COLOR, 0, back_color);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
-    ExitOnGLError(ctx, "ERROR: Could not clear frame buffer 2");
-
-    if(ret = DrawTiles(ctx, rotations, res2))
-        return AVERROR(ret);
-
-    glReadBuffer(GL_COLOR_ATTACHMENT0);
-    ExitOnGLError(ctx, "ERROR: Could not read buffer");
-
-    frame->linesize[1] = s->w >> s->hsub;
-    glReadPixels(0, 0, s->w >> s->hsub, s->h >> s->vsub, GL_RED, GL_UNSIGNED_BYTE, frame->data[1]);
-    ExitOnGLError(ctx, "ERROR: Could not read pixel");
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-    // v plane
-    glViewport(0, 0, s->w >> s->hsub, s->h >> s->vsub);
-
-    LoadTexture(ctx, in_w >> s->hsub, in_h >> s->vsub, s->ori_buffer[2]);
-    glBindTexture(GL_TEXTURE_2D, s->TextureId);
+             s->max_step[0], s->max_step[1], s->max_step[2], s->outs[0]->linesize[0], s->outs[0]->linesize[1], s->outs[0]->linesize[2],
+             s->targets[0].w, s->targets[0].h, s->vsub, s->hsub);
+
+    // every view samples the textures uploaded above
+    for(v = 0; v < s->nb_targets; v++){
+        if(ret = render_target(ctx, v, s->outs[v], rotations)){
+            UnlockGLContext();
+            free_outs(s);
+            return AVERROR(ret);
+        }
+    }
 
-    CreateFramebuffer2(ctx, (s->w >> s->hsub), (s->h >> s->vsub));
-    glBindFramebuffer(GL_FRAMEBUFFER, s->FramebufferId2);
-    ExitOnGLError(ctx, "ERROR: Could not bind frame buffer 2");
-    glDrawBuffers(1, draw_buffers);
-    glClearBufferfv(GL_COLOR, 0, back_color);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
-    ExitOnGLError(ctx, "ERROR: Could not clear frame buffer 2");
+    for(j = pass_max_planes(s) - 1; j >= 0; j--){
+        glActiveTexture(GL_TEXTURE0 + j);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
 
-    if(ret = DrawTiles(ctx, rotations, res2))
-        return AVERROR(ret);
+    if(s->pipeline){
+        ret = QueueReadback(ctx, s->outs);
+        UnlockGLContext();
+        return ret;
+    }
+    UnlockGLContext();
 
-    glReadBuffer(GL_COLOR_ATTACHMENT0);
-    ExitOnGLError(ctx, "ERROR: Could not read buffer");
+    return send_outs(ctx);
+}
 
-    frame->linesize[2] = s->w >> s->hsub;
-    glReadPixels(0, 0, s->w >> s->hsub, s->h >> s->vsub, GL_RED, GL_UNSIGNED_BYTE, frame->data[2]);
-    ExitOnGLError(ctx, "ERROR: Could not read pixel");
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+static int request_frame(AVFilterLink *link)
+{
+    AVFilterContext *ctx = link->src;
+    ProjectContext *s = ctx->priv;
+    int ret;
 
-    glBindTexture(GL_TEXTURE_2D, 0);
+    ret = ff_request_frame(ctx->inputs[0]);
 
-    if(frame->data[3])
-        memset(frame->data[3], 255, frame->height * frame->linesize[3]);
+    // drain the frames still waiting in the readback pipeline
+    if(ret == AVERROR_EOF && s->rb_queued > 0){
+        LockGLContext();
+        ret = FlushReadbacks(ctx, 0);
+        UnlockGLContext();
+    }
 
-    return ff_filter_frame(link->dst->outputs[0], frame);
+    return ret;
 }
 
 static int process_command(AVFilterContext *ctx, const char *cmd, const char *args,
@@ -949,8 +2671,17 @@ static int process_command(AVFilterContext *ctx, const char *cmd, const char *ar
         int old_w = s->w;
         int old_h = s->h;
 
-        AVFilterLink *outlink = ctx->outputs[0];
         AVFilterLink *inlink  = ctx->inputs[0];
+        int v;
+
+        // queued frames were rendered with the old size
+        if (s->rb_queued > 0) {
+            LockGLContext();
+            ret = FlushReadbacks(ctx, 0);
+            UnlockGLContext();
+            if (ret < 0)
+                return ret;
+        }
 
         av_opt_set(s, cmd, args, 0);
 
@@ -962,7 +2693,8 @@ static int process_command(AVFilterContext *ctx, const char *cmd, const char *ar
             return ret;
         }
 
-        ret = config_output(outlink);
+        for(v = 0; v < ctx->nb_outputs && ret >= 0; v++)
+            ret = config_output(ctx->outputs[v]);
 
     } else
         ret = AVERROR(ENOSYS);
@@ -986,13 +2718,38 @@ static const AVOption project_options[] = {
     { "vshader",     "set the vertex shader path",              OFFSET(vshader), AV_OPT_TYPE_STRING, {.str = ""},  CHAR_MIN, CHAR_MAX, FLAGS },
     { "fshader",     "set the fragment shader path",            OFFSET(fshader), AV_OPT_TYPE_STRING, {.str = ""},  CHAR_MIN, CHAR_MAX, FLAGS },
     { "orfile",      "set the orientation file",                OFFSET(orfile), AV_OPT_TYPE_STRING, {.str = ""},   CHAR_MIN, CHAR_MAX, FLAGS },
+    { "orfeed",      "set the unix domain socket or fifo of a live orientation feed", OFFSET(orfeed), AV_OPT_TYPE_STRING, {.str = ""}, CHAR_MIN, CHAR_MAX, FLAGS },
+    { "sidedata",    "take the orientation from frame side data", OFFSET(sidedata), AV_OPT_TYPE_BOOL, {.i64=0}, 0, 1, FLAGS },
+    { "orinterp",    "interpolate between orientation samples", OFFSET(orinterp), AV_OPT_TYPE_BOOL, {.i64=0}, 0, 1, FLAGS },
     { "lofile",      "set the layout file",                     OFFSET(lofile), AV_OPT_TYPE_STRING, {.str = ""},   CHAR_MIN, CHAR_MAX, FLAGS },
+    { "views",       "set the layout file of views rendered to separate outputs", OFFSET(viewsfile), AV_OPT_TYPE_STRING, {.str = ""}, CHAR_MIN, CHAR_MAX, FLAGS },
+    { "olofile",     "set the output layout file",              OFFSET(olofile), AV_OPT_TYPE_STRING, {.str = ""},  CHAR_MIN, CHAR_MAX, FLAGS },
+    { "align",       "set the alignment of views from a layout file", OFFSET(align), AV_OPT_TYPE_INT, {.i64=8}, 1, 64, FLAGS },
     { "timebase",    "set time base for loading orientation",   OFFSET(tb), AV_OPT_TYPE_DOUBLE,     {.dbl = 0},    0, 999999, FLAGS },
     { "ecoef",       "set expansion coefficient",               OFFSET(ecoef), AV_OPT_TYPE_DOUBLE,  {.dbl = 1.0},  0.8,1.2, FLAGS},
     { "x",           "set the x project area expression",       OFFSET(x_expr), AV_OPT_TYPE_STRING, {.str = "(in_w-out_w)/2"}, CHAR_MIN, CHAR_MAX, FLAGS },
     { "y",           "set the y project area expression",       OFFSET(y_expr), AV_OPT_TYPE_STRING, {.str = "(in_h-out_h)/2"}, CHAR_MIN, CHAR_MAX, FLAGS },
     { "keep_aspect", "keep aspect ratio",                       OFFSET(keep_aspect), AV_OPT_TYPE_BOOL, {.i64=0}, 0, 1, FLAGS },
     { "exact",       "do exact projecting",                     OFFSET(exact),  AV_OPT_TYPE_BOOL, {.i64=0}, 0, 1, FLAGS },
+    { "mrt",         "render planes of the same size in one draw",   OFFSET(mrt), AV_OPT_TYPE_BOOL, {.i64=0}, 0, 1, FLAGS },
+    { "pipeline",    "set number of frames read back asynchronously", OFFSET(pipeline), AV_OPT_TYPE_INT, {.i64=0}, 0, 16, FLAGS },
+    { "backend",     "set the rendering backend",               OFFSET(backend), AV_OPT_TYPE_INT, {.i64=BACKEND_GL}, 0, NB_BACKENDS-1, FLAGS, "backend" },
+        { "gl",      "render with OpenGL",                      0, AV_OPT_TYPE_CONST, {.i64=BACKEND_GL},  0, 0, FLAGS, "backend" },
+        { "cpu",     "remap with lookup tables on the CPU",     0, AV_OPT_TYPE_CONST, {.i64=BACKEND_CPU}, 0, 0, FLAGS, "backend" },
+    { "lutfmt",      "set the format of the cpu remap tables",  OFFSET(lutfmt), AV_OPT_TYPE_INT, {.i64=LUT_FLOAT}, 0, NB_LUT_FORMATS-1, FLAGS, "lutfmt" },
+        { "float",   "float texel coordinates",                 0, AV_OPT_TYPE_CONST, {.i64=LUT_FLOAT}, 0, 0, FLAGS, "lutfmt" },
+        { "fixed",   "12.4 fixed-point texel coordinates",      0, AV_OPT_TYPE_CONST, {.i64=LUT_FIXED}, 0, 0, FLAGS, "lutfmt" },
+    { "cachedir",    "set the directory caching the cpu remap tables and the shader program binaries", OFFSET(cachedir), AV_OPT_TYPE_STRING, {.str = ""}, CHAR_MIN, CHAR_MAX, FLAGS },
+    { "iecoef",      "set expansion coefficient of the input tiles, 0 for the shader's", OFFSET(iecoef), AV_OPT_TYPE_DOUBLE, {.dbl = 0}, 0, 1.2, FLAGS},
+    { "insampling",  "set how toequirectangular.glsl samples the input tiles", OFFSET(insampling), AV_OPT_TYPE_INT, {.i64=SAMPLING_EQDIS}, 0, NB_SAMPLINGS-1, FLAGS, "insampling" },
+        { "eqdis",   "like eqdis.glsl",                         0, AV_OPT_TYPE_CONST, {.i64=SAMPLING_EQDIS},   0, 0, FLAGS, "insampling" },
+        { "eqdeg",   "like eqdeg.glsl",                         0, AV_OPT_TYPE_CONST, {.i64=SAMPLING_EQDEG},   0, 0, FLAGS, "insampling" },
+        { "uneqdeg", "like uneqdeg.glsl",                       0, AV_OPT_TYPE_CONST, {.i64=SAMPLING_UNEQDEG}, 0, 0, FLAGS, "insampling" },
+    { "mipmap",      "set the minification of the input by the gl backend", OFFSET(mipmap), AV_OPT_TYPE_INT, {.i64=MIPMAP_NONE}, 0, NB_MIPMAPS-1, FLAGS, "mipmap" },
+        { "none",      "bilinear, from the full-size input",    0, AV_OPT_TYPE_CONST, {.i64=MIPMAP_NONE},      0, 0, FLAGS, "mipmap" },
+        { "trilinear", "mipmaps generated on upload",           0, AV_OPT_TYPE_CONST, {.i64=MIPMAP_TRILINEAR}, 0, 0, FLAGS, "mipmap" },
+        { "aniso",     "mipmaps and anisotropic filtering",     0, AV_OPT_TYPE_CONST, {.i64=MIPMAP_ANISO},     0, 0, FLAGS, "mipmap" },
+    { "aniso",       "set the maximum anisotropy of mipmap=aniso", OFFSET(aniso), AV_OPT_TYPE_DOUBLE, {.dbl = 16}, 1, 16, FLAGS},
     { NULL }
 };
 
@@ -1008,15 +2765,6 @@ static const AVFilterPad avfilter_vf_project_inputs[] = {
     { NULL }
 };
 
-static const AVFilterPad avfilter_vf_project_outputs[] = {
-    {
-        .name         = "default",
-        .type         = AVMEDIA_TYPE_VIDEO,
-        .config_props = config_output,
-    },
-    { NULL }
-};
-
 AVFilter ff_vf_project = {
     .name            = "project",
     .description     = NULL_IF_CONFIG_SMALL("Project the input cubic layout video."),
@@ -1026,16 +2774,15 @@ AVFilter ff_vf_project = {
     .uninit          = uninit,
     .init            = init,
     .inputs          = avfilter_vf_project_inputs,
-    .outputs         = avfilter_vf_project_outputs,
+    .outputs         = NULL,
     .process_command = process_command,
+    .flags           = AVFILTER_FLAG_DYNAMIC_OUTPUTS | AVFILTER_FLAG_SLICE_THREADS,
 };
 
 int CreateTiles(AVFilterContext *ctx)
 {
     ProjectContext *s = ctx->priv;
-    GLint logSize = 0;
-    GLchar *log = NULL;
-    int i, j;
+    int i, j, ret;
     double px, py, pz, pu, pv;
     double lx, rx, ty, by; // left_x, right_x, top_y, bottom_y
     Matrix rotation;
@@ -1043,15 +2790,17 @@ int CreateTiles(AVFilterContext *ctx)
     av_log(ctx, AV_LOG_INFO, "[Project Filter] Creating Tiles......\n");
     av_log(ctx, AV_LOG_INFO, "[Project Filter] \n");
 
-    // each tile is drawn by 6 vertices
-    s->vertices = malloc(sizeof(Vertex) * 6 * s->layout->nr);
+    // each tile is drawn by 6 vertices, followed by a quad over the whole view for toequirectangular.glsl
+    s->vertices = calloc(6 * (s->layout->nr + 1), sizeof(Vertex));
+    if(!s->vertices)
+        return ENOMEM;
     for(i = 0; i < s->layout->nr; i++){
         /* Create tile vertices here */
         /* use the args in s->tiles[i], which are x, y, z, fovx, fovy, u, v */
 
-        lx = -1 * tan( DegreesToRadians( s->tiles[i].fovx / 2 ) );
+        lx = -1 * pm_tile_extent(s->tiles[i].fovx);
         rx = -1 * lx;
-        ty = tan( DegreesToRadians( s->tiles[i].fovy / 2 ) );
+        ty = pm_tile_extent(s->tiles[i].fovy);
         by = -1 * ty;
 
         rotation = IDENTITY_MATRIX;
@@ -1116,52 +2865,56 @@ int CreateTiles(AVFilterContext *ctx)
         av_log(ctx, AV_LOG_INFO, "[Project Filter]\n After applying rotation, the left-top corner is: (%.2f, %.2f, %.2f, %.2f)\n",
  s->vertices[i*6].position[0], s->vertices[i*6].position[1], s->vertices[i*6].position[2], s->vertices[i*6].position[3]);
     }
-
-    glfwMakeContextCurrent (s->WindowHandle);
-    // ShaderIds[3]: ProgramId, VertexShaderId, FragmentShaderId
-    s->ShaderIds[0] = glCreateProgram();
-    ExitOnGLError(ctx, "ERROR: Could not create the shader program");
-
-    s->ShaderIds[1] = LoadShader(ctx, s->fshader, GL_FRAGMENT_SHADER);
-    s->ShaderIds[2] = LoadShader(ctx, s->vshader, GL_VERTEX_SHADER);
-
-    if(s->ShaderIds[1] == 0 || s->ShaderIds[2] == 0){
-        av_log(ctx, AV_LOG_ERROR, "[Project Filter] Error on loading vertex/fragment shaders: ('%s'/'%s')\n", s->vshader, s->fshader);
-        return AVERROR(ENOSYS);
+    for(j = 0; j < 6; j++){
+        s->vertices[i * 6 + j].position[0] = j == 1 || j == 2 || j == 4 ? 1 : -1;
+        s->vertices[i * 6 + j].position[1] = j == 2 || j == 4 || j == 5 ? 1 : -1;
+        s->vertices[i * 6 + j].position[3] = 1.0f;
     }
 
-    glAttachShader(s->ShaderIds[0], s->ShaderIds[1]);
-    glAttachShader(s->ShaderIds[0], s->ShaderIds[2]);
+    // the plane with several channels is the only one of packed formats and the chroma of semi-planar ones
+    if(s->channels[0] == 1 && (ret = CreateProgram(ctx, &s->programs[0], 1, 1)))
+        return ret;
+    if(pass_max_planes(s) > 1 && (ret = CreateProgram(ctx, &s->programs[1], pass_max_planes(s), 1)))
+        return ret;
+    for(i = 0; i < s->nb_planes; i++)
+        if(s->channels[i] > 1 && (ret = CreateProgram(ctx, &s->programs[2], 1, s->channels[i] > 2 ? 4 : s->channels[i])))
+            return ret;
 
-    //av_log(ctx, AV_LOG_INFO, "[OpenGL] INFO: program id %d, fragshader id %d, vertexshader id %d\n", s->ShaderIds[0], s->ShaderIds[1], s->ShaderIds[2]);
+    // BufferIds[3]: VAO, VBO1 (pos), UBO (tiles of toequirectangular.glsl)
+    glGenBuffers(3, &s->BufferIds[1]);
+    ExitOnGLError(ctx, "ERROR: Could not generate the buffer objects");
 
-    glLinkProgram(s->ShaderIds[0]);
-    ExitOnGLError(ctx, "ERROR: Could not link the shader program");
+    if(s->shader == SHADER_TO_EQUIRECTANGULAR){
+        GLint max_size = 0;
+        glGetIntegerv(GL_MAX_UNIFORM_BLOCK_SIZE, &max_size);
+        if(s->layout->nr * TILE_UNIFORM_SIZE > (size_t)max_size){
+            av_log(ctx, AV_LOG_ERROR, "[Project Filter] %d tiles exceed the uniform block size of %d bytes\n", (int)s->layout->nr, max_size);
+            return EINVAL;
+        }
+        s->tile_block = av_mallocz(s->layout->nr * TILE_UNIFORM_SIZE);
+        s->tile_rays = av_malloc_array(s->layout->nr, 9 * sizeof(*s->tile_rays));
+        if(!s->tile_block || !s->tile_rays)
+            return ENOMEM;
+
+        // std140 layout of struct Tile: three rows, the extent and the rectangle, vec4 each;
+        // only the rows follow the orientation, see update_tile_uniforms()
+        for(i = 0; i < s->layout->nr; i++){
+            GLfloat *b = s->tile_block + i * TILE_UNIFORM_SIZE / sizeof(GLfloat);
+            b[12] = pm_tile_extent(s->tiles[i].fovx);
+            b[13] = pm_tile_extent(s->tiles[i].fovy);
+            b[16] = s->tiles[i].u;
+            b[17] = s->tiles[i].v;
+            b[18] = s->tiles[i].w;
+            b[19] = s->tiles[i].h;
+        }
+        s->tile_rows_set = 0;
 
-    if(GL_NO_ERROR != glGetError()){
-        glGetProgramiv(s->ShaderIds[0], GL_INFO_LOG_LENGTH, &logSize);
-        av_log(ctx, AV_LOG_INFO, "ERROR: use program failed. log length(%d)\n", logSize);
-        log = malloc(logSize * sizeof(GLchar));
-        glGetProgramInfoLog(s->ShaderIds[0], logSize, NULL, log);
-        av_log(ctx, AV_LOG_INFO, "  use program error info: %s\n", log);
-        free(log);
+        glBindBuffer(GL_UNIFORM_BUFFER, s->BufferIds[2]);
+        glBufferData(GL_UNIFORM_BUFFER, s->layout->nr * TILE_UNIFORM_SIZE, s->tile_block, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        ExitOnGLError(ctx, "ERROR: Could not create the tile uniform buffer");
     }
 
-    s->ModelMatrixUniformLocation = glGetUniformLocation(s->ShaderIds[0], "ModelMatrix");
-    s->ViewMatrixUniformLocation = glGetUniformLocation(s->ShaderIds[0], "ViewMatrix");
-    s->ProjectionMatrixUniformLocation = glGetUniformLocation(s->ShaderIds[0], "ProjectionMatrix");
-    s->ResolutionUniformLocation = glGetUniformLocation(s->ShaderIds[0], "resolution");
-    s->FovUniformLocation = glGetUniformLocation(s->ShaderIds[0], "fov");
-    s->YawUniformLocation = glGetUniformLocation(s->ShaderIds[0], "yaw");
-    s->PitchUniformLocation = glGetUniformLocation(s->ShaderIds[0], "pitch");
-    s->RollUniformLocation = glGetUniformLocation(s->ShaderIds[0], "roll");
-
-    ExitOnGLError(ctx, "ERROR: Could not get the shader uniform locations");
-
-    // BufferIds[3]: VAO, VBO1 (pos), VBO2 (uv)
-    glGenBuffers(3, &s->BufferIds[1]);
-    ExitOnGLError(ctx, "ERROR: Could not generate the buffer objects");
-
     glGenVertexArrays(1, &s->BufferIds[0]);
     ExitOnGLError(ctx, "ERROR: Could not generate the VAO");
     glBindVertexArray(s->BufferIds[0]);
@@ -1173,7 +2926,7 @@ int CreateTiles(AVFilterContext *ctx)
     ExitOnGLError(ctx, "ERROR: Could not enable vertex attributes");
 
     glBindBuffer(GL_ARRAY_BUFFER, s->BufferIds[1]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * 6 * s->layout->nr, s->vertices, GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * 6 * (s->layout->nr + 1), s->vertices, GL_STATIC_DRAW);
     ExitOnGLError(ctx, "ERROR: Could not bind the VBO to the VAO");
 
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(s->vertices[0]), (GLvoid*)0);
@@ -1186,13 +2939,102 @@ int CreateTiles(AVFilterContext *ctx)
     return 0;
 }
 
-int DrawTiles(AVFilterContext *ctx, double rotations[3], const GLfloat res[2])
+// Get the program rendering the given number of planes of so many channels at once,
+// compiled by this or another instance
+int CreateProgram(AVFilterContext *ctx, program_t *prog, int planes, int channels)
+{
+    ProjectContext *s = ctx->priv;
+    const builtin_shader_t *shader = s->shader >= 0 ? &builtin_fshaders[s->shader] : NULL;
+    char defines[192] = "";
+    int i;
+
+    // built-in variants are specialized at compile time
+    if(shader){
+        av_strlcat(defines, shader->defines, sizeof(defines));
+        if(s->sampling >= 0)
+            av_strlcatf(defines, sizeof(defines), "#define PROJECTION %s\n", sampling_names[s->sampling]);
+        if(s->in_ecoef != 1.0)
+            av_strlcatf(defines, sizeof(defines), "#define ECOEF %.9f\n", s->in_ecoef);
+        if(s->shader == SHADER_TO_EQUIRECTANGULAR)
+            av_strlcatf(defines, sizeof(defines), "#define TILES %d\n", (int)s->layout->nr);
+        if(s->mipmap != MIPMAP_NONE)
+            av_strlcat(defines, "#define MIPMAP\n", sizeof(defines));
+    }
+    if(planes > 1 || channels > 1)
+        av_strlcatf(defines, sizeof(defines), "#define PLANES %d\n#define CHANNELS %d\n", planes, channels);
+
+    prog->ProgramId = AcquireProgram(ctx, s->vshader, shader ? shader->file : s->fshader, *defines ? defines : NULL, s->cachedir);
+    if(!prog->ProgramId){
+        av_log(ctx, AV_LOG_ERROR, "[Project Filter] Error on loading vertex/fragment shaders: ('%s'/'%s')\n", s->vshader, s->fshader);
+        return AVERROR(ENOSYS);
+    }
+
+    prog->ModelMatrixUniformLocation = glGetUniformLocation(prog->ProgramId, "ModelMatrix");
+    prog->ViewMatrixUniformLocation = glGetUniformLocation(prog->ProgramId, "ViewMatrix");
+    prog->ProjectionMatrixUniformLocation = glGetUniformLocation(prog->ProgramId, "ProjectionMatrix");
+    prog->ResolutionUniformLocation = glGetUniformLocation(prog->ProgramId, "resolution");
+    prog->FovUniformLocation = glGetUniformLocation(prog->ProgramId, "fov");
+    prog->YawUniformLocation = glGetUniformLocation(prog->ProgramId, "yaw");
+    prog->PitchUniformLocation = glGetUniformLocation(prog->ProgramId, "pitch");
+    prog->RollUniformLocation = glGetUniformLocation(prog->ProgramId, "roll");
+    prog->RotationUniformLocation = glGetUniformLocation(prog->ProgramId, "rotation");
+    prog->FocalUniformLocation = glGetUniformLocation(prog->ProgramId, "focal");
+    prog->TilesBlockIndex = glGetUniformBlockIndex(prog->ProgramId, "Tiles");
+    if(prog->TilesBlockIndex != GL_INVALID_INDEX)
+        glUniformBlockBinding(prog->ProgramId, prog->TilesBlockIndex, 0);
+    prog->OriginUniformLocation = glGetUniformLocation(prog->ProgramId, "origin");
+
+    ExitOnGLError(ctx, "ERROR: Could not get the shader uniform locations");
+
+    // plane i of a pass is bound to texture unit i
+    glUseProgram(prog->ProgramId);
+    for(i = 0; i < planes; i++){
+        snprintf(defines, sizeof(defines), i ? "textureSampler%d" : "textureSampler", i);
+        glUniform1i(glGetUniformLocation(prog->ProgramId, defines), i);
+    }
+    glUseProgram(0);
+    ExitOnGLError(ctx, "ERROR: Could not set the texture samplers");
+
+    return 0;
+}
+
+// Upload the Tiles block of toequirectangular.glsl for the orientation of a view
+static int update_tile_uniforms(AVFilterContext *ctx, const double rotations[3])
+{
+    ProjectContext *s = ctx->priv;
+    GLfloat *b;
+    int i, j, k;
+
+    glBindBufferBase(GL_UNIFORM_BUFFER, 0, s->BufferIds[2]);
+
+    // the rows are uploaded again only when the orientation changed since the last draw
+    if(!s->tile_rows_set || memcmp(rotations, s->tile_rotations, sizeof(s->tile_rotations))){
+        erp_tile_matrices(s, rotations, s->tile_rays);
+        for(i = 0; i < s->layout->nr; i++){
+            b = s->tile_block + i * TILE_UNIFORM_SIZE / sizeof(GLfloat);
+            for(j = 0; j < 3; j++)
+                for(k = 0; k < 3; k++)
+                    b[4 * j + k] = s->tile_rays[9 * i + 3 * j + k];
+            glBufferSubData(GL_UNIFORM_BUFFER, i * TILE_UNIFORM_SIZE, 3 * 4 * sizeof(GLfloat), b);
+        }
+        memcpy(s->tile_rotations, rotations, sizeof(s->tile_rotations));
+        s->tile_rows_set = 1;
+    }
+
+    if(CheckGLError(ctx, "ERROR: Could not update the tile uniforms"))
+        return ENOSYS;
+    return 0;
+}
+
+int DrawTiles(AVFilterContext *ctx, program_t *prog, const view_t *view, double rotations[3], const GLfloat res[2], const GLfloat origin[2])
 {
     ProjectContext *s = ctx->priv;
-    static int count = 0;
+    double erp[9];
+    GLfloat rotation[9];
+    int i, ret;
 
     /* s->ProjectionMatrix = CreateProjectionMatrix((float)(s->vfov), (s->h * 1.0f / s->w), .1f, 5.0f); */
-    s->ProjectionMatrix = CreateProjectionMatrix(s->fovx, s->fovy, .5f, 2.0f);
+    s->ProjectionMatrix = CreateProjectionMatrix(view->fovx, view->fovy, NEAR_PLANE, FAR_PLANE);
 
     s->ModelMatrix = IDENTITY_MATRIX;
 
@@ -1204,50 +3046,44 @@ int DrawTiles(AVFilterContext *ctx, double rotations[3], const GLfloat res[2])
     s->ViewMatrix = IDENTITY_MATRIX;
     // TranslateMatrix(&s->ViewMatrix, 0, 0, 1.0);
 
-    glUseProgram(s->ShaderIds[0]);
+    glUseProgram(prog->ProgramId);
     if(CheckGLError(ctx, "ERROR: Could not use the shader program"))
         return ENOSYS;
 
-    glUniformMatrix4fv(s->ModelMatrixUniformLocation, 1, GL_FALSE, s->ModelMatrix.m);
-    glUniformMatrix4fv(s->ViewMatrixUniformLocation, 1, GL_FALSE, s->ViewMatrix.m);
-    glUniformMatrix4fv(s->ProjectionMatrixUniformLocation, 1, GL_FALSE, s->ProjectionMatrix.m);
-    /* glUniformMatrix4fv(s->ProjectionMatrixUniformLocation, 1, GL_FALSE, IDENTITY_MATRIX.m); */
-
-    glUniform2fv(s->ResolutionUniformLocation, 1, res);
-    glUniform1f(s->FovUniformLocation, s->fovx);
-    glUniform1f(s->YawUniformLocation, rotations[1]);
-    glUniform1f(s->PitchUniformLocation, rotations[0]);
-    glUniform1f(s->RollUniformLocation, rotations[2]);
+    glUniformMatrix4fv(prog->ModelMatrixUniformLocation, 1, GL_FALSE, s->ModelMatrix.m);
+    glUniformMatrix4fv(prog->ViewMatrixUniformLocation, 1, GL_FALSE, s->ViewMatrix.m);
+    glUniformMatrix4fv(prog->ProjectionMatrixUniformLocation, 1, GL_FALSE, s->ProjectionMatrix.m);
+    /* glUniformMatrix4fv(prog->ProjectionMatrixUniformLocation, 1, GL_FALSE, IDENTITY_MATRIX.m); */
+
+    glUniform2fv(prog->ResolutionUniformLocation, 1, res);
+    glUniform2fv(prog->OriginUniformLocation, 1, origin);
+    glUniform1f(prog->FovUniformLocation, view->fovx);
+    glUniform1f(prog->YawUniformLocation, rotations[1]);
+    glUniform1f(prog->PitchUniformLocation, rotations[0]);
+    glUniform1f(prog->RollUniformLocation, rotations[2]);
+
+    // constant per view, so the equirectangular shaders are left with the per-pixel lookup
+    erp_rotation_matrix(erp, rotations);
+    for(i = 0; i < 9; i++)
+        rotation[i] = erp[i];
+    glUniformMatrix3fv(prog->RotationUniformLocation, 1, GL_TRUE, rotation);
+    glUniform1f(prog->FocalUniformLocation, 0.5 / tan(0.5 * DegreesToRadians(view->fovx)));
 
     if(CheckGLError(ctx, "ERROR: Could not set the shader uniforms"))
         return ENOSYS;
 
-    glBindVertexArray(s->BufferIds[0]);
-    if(CheckGLError(ctx, "ERROR: Could not bind the VAO for drawing purpose"))
-        return ENOSYS;
+    if(s->shader == SHADER_TO_EQUIRECTANGULAR && (ret = update_tile_uniforms(ctx, rotations)))
+        return ret;
 
+    // the VAO set up in CreateTiles() holds the vertex buffer and attribute layout
     glBindVertexArray(s->BufferIds[0]);
-    if(CheckGLError(ctx, "ERROR: Could not bind the VAO"))
-        return ENOSYS;
-
-    glEnableVertexAttribArray(0);
-    glEnableVertexAttribArray(1);
-    glEnableVertexAttribArray(2);
-    if(CheckGLError(ctx, "ERROR: Could not enable vertex attributes"))
-        return ENOSYS;
-
-    glBindBuffer(GL_ARRAY_BUFFER, s->BufferIds[1]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * 6 * s->layout->nr, s->vertices, GL_STATIC_DRAW);
-    if(CheckGLError(ctx, "ERROR: Could not bind the VBO to the VAO"))
-        return ENOSYS;
-
-    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(s->vertices[0]), (GLvoid*)0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(s->vertices[0]), (GLvoid*)(sizeof(s->vertices[0].position)));
-    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(s->vertices[0]), (GLvoid*)(sizeof(s->vertices[0].position) + sizeof(s->vertices[0].uv)));
-    if(CheckGLError(ctx, "ERROR: Could not set VAO attribute"))
+    if(CheckGLError(ctx, "ERROR: Could not bind the VAO for drawing purpose"))
         return ENOSYS;
 
-    glDrawArrays(GL_TRIANGLES, 0, s->layout->nr * 6);
+    if(s->shader == SHADER_TO_EQUIRECTANGULAR)
+        glDrawArrays(GL_TRIANGLES, s->layout->nr * 6, 6);
+    else
+        glDrawArrays(GL_TRIANGLES, 0, s->layout->nr * 6);
 
     if(CheckGLError(ctx, "ERROR: Could not draw the tiles"))
         return ENOSYS;
@@ -1255,7 +3091,7 @@ int DrawTiles(AVFilterContext *ctx, double rotations[3], const GLfloat res[2])
     glBindVertexArray(0);
     glUseProgram(0);
 
-    count++;
+    s->nb_draws++;
     return 0;
 }
 
@@ -1263,29 +3099,12 @@ void DestroyCube(AVFilterContext *ctx)
 {
     ProjectContext *s = ctx->priv;
 
-    if(s->WindowHandle >= 0)
-        glfwMakeContextCurrent (s->WindowHandle);
-
-    //av_log(ctx, AV_LOG_INFO, "[OpenGL] INFO: program id %d, fragshader id %d, vertexshader id %d\n", s->ShaderIds[0], s->ShaderIds[1], s->ShaderIds[2]);
-
-    if(s->ShaderIds[1]){
-        glDetachShader(s->ShaderIds[0], s->ShaderIds[1]);
-        ExitOnGLError(ctx, "ERROR: Could not detach shader 1");
-        glDeleteShader(s->ShaderIds[1]);
-    }
-    if(s->ShaderIds[2]){
-        glDetachShader(s->ShaderIds[0], s->ShaderIds[2]);
-        ExitOnGLError(ctx, "ERROR: Could not detach shader 2");
-        glDeleteShader(s->ShaderIds[2]);
-    }
-
-    if(s->ShaderIds[0]){
-        glDeleteProgram(s->ShaderIds[0]);
-        ExitOnGLError(ctx, "ERROR: Could not destroy the program objects");
-    }
+    DestroyProgram(ctx, &s->programs[0]);
+    DestroyProgram(ctx, &s->programs[1]);
+    DestroyProgram(ctx, &s->programs[2]);
 
     if(s->BufferIds[1]){
-        glDeleteBuffers(2, &s->BufferIds[1]);
+        glDeleteBuffers(3, &s->BufferIds[1]);
         ExitOnGLError(ctx, "ERROR: Could not destroy the buffer objects");
     }
 
@@ -1293,94 +3112,355 @@ void DestroyCube(AVFilterContext *ctx)
         glDeleteVertexArrays(1, &s->BufferIds[0]);
         ExitOnGLError(ctx, "ERROR: Could not destroy the buffer objects");
     }
+
+    memset(s->BufferIds, 0, sizeof(s->BufferIds));
+    av_freep(&s->tile_block);
+    av_freep(&s->tile_rays);
 }
 
-int CreateTexutre(AVFilterContext *ctx)
+void DestroyProgram(AVFilterContext *ctx, program_t *prog)
+{
+    if(prog->ProgramId)
+        ReleaseProgram(ctx, prog->ProgramId);
+
+    memset(prog, 0, sizeof(*prog));
+}
+
+// Texture storage is allocated once per plane, frames only update its contents.
+// With mipmap, it holds the full chain of levels LoadTexture() regenerates.
+int CreateTexutre(AVFilterContext *ctx, int plane, int w, int h)
 {
     ProjectContext *s = ctx->priv;
+    GLfloat max_aniso;
+    int levels = 1;
 
-    glGenTextures(1, &s->TextureId);
+    if(s->mipmap != MIPMAP_NONE)
+        while(FFMAX(w, h) >> levels)
+            levels++;
+
+    glGenTextures(1, &s->TextureIds[plane]);
     glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, s->TextureId);
+    glBindTexture(GL_TEXTURE_2D, s->TextureIds[plane]);
+
+    if(GLEW_ARB_texture_storage)
+        glTexStorage2D(GL_TEXTURE_2D, levels, s->InternalFormats[plane], w, h);
+    else
+        glTexImage2D(GL_TEXTURE_2D, 0, s->InternalFormats[plane], w, h, 0, s->PixelFormats[plane], s->PixelType, NULL);
+    if(CheckGLError(ctx, "ERROR: Could not allocate texture storage"))
+        return ENOSYS;
 
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+    if(s->mipmap == MIPMAP_ANISO){
+        if(GLEW_EXT_texture_filter_anisotropic){
+            glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &max_aniso);
+            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, FFMIN(s->aniso, max_aniso));
+        }else if(!plane)
+            av_log(ctx, AV_LOG_WARNING, "[Project Filter] anisotropic filtering is not supported, using trilinear\n");
+    }
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     if(CheckGLError(ctx, "ERROR: Could not setup texture parameter"))
         return ENOSYS;
 
     glBindTexture(GL_TEXTURE_2D, 0);
+
+    s->tex_w[plane] = w;
+    s->tex_h[plane] = h;
+    s->tex_levels[plane] = levels;
     return 0;
 }
 
 // May need to do some work on checking pixel format
-void LoadTexture(AVFilterContext *ctx, int w, int h, uint8_t *img)
+// The plane is read in place: linesize is handed to GL as the unpack row length
+void LoadTexture(AVFilterContext *ctx, int plane, int linesize, const uint8_t *img)
 {
     ProjectContext *s = ctx->priv;
+    const int w = s->tex_w[plane], h = s->tex_h[plane];
+    const int pixel_size = s->bytes * s->channels[plane];
+    int i;
 
-    glBindTexture(GL_TEXTURE_2D, s->TextureId);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, w, h, 0, GL_RED, GL_UNSIGNED_BYTE, img);
+    glBindTexture(GL_TEXTURE_2D, s->TextureIds[plane]);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if(linesize >= 0 && !(linesize % pixel_size)){
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, linesize / pixel_size);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, s->PixelFormats[plane], s->PixelType, img);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    }else{
+        // bottom-up planes (e.g. after vflip) and rows of packed RGB24 not ending on a
+        // pixel boundary cannot be described by a row length
+        for(i = 0; i < h; i++)
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, i, w, 1, s->PixelFormats[plane], s->PixelType, img + i * linesize);
+    }
+    if(s->tex_levels[plane] > 1)
+        glGenerateMipmap(GL_TEXTURE_2D);
     ExitOnGLError(ctx, "ERROR: Could not load image to texture");
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    ExitOnGLError(ctx, "ERROR: Could not setup texture parameter");
-
     glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 void DestroyTexture(AVFilterContext *ctx)
 {
     ProjectContext *s = ctx->priv;
+    int i;
 
-    glDeleteTextures(1, &s->TextureId);
+    for(i = 0; i < 3; i++){
+        if(s->TextureIds[i])
+            glDeleteTextures(1, &s->TextureIds[i]);
+        s->TextureIds[i] = 0;
+    }
     ExitOnGLError(ctx, "ERROR: Could not destroy the texture");
 }
 
-void CreateFramebuffer(AVFilterContext *ctx, int w, int h)
+int CreateRenderbuffer(AVFilterContext *ctx, target_t *target, int plane, int w, int h)
 {
     ProjectContext *s = ctx->priv;
 
-    glBindRenderbuffer(GL_RENDERBUFFER, s->RenderbufferId);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_R8, w, h);
+    glGenRenderbuffers(1, &target->RenderbufferIds[plane]);
+    glBindRenderbuffer(GL_RENDERBUFFER, target->RenderbufferIds[plane]);
+    glRenderbufferStorage(GL_RENDERBUFFER, s->InternalFormats[plane], w, h);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    if(CheckGLError(ctx, "ERROR: Could not generate render buffer"))
+        return ENOSYS;
+
+    return 0;
+}
+
+// Attach the render buffers of all planes of a pass as its color attachments
+int CreateFramebuffer(AVFilterContext *ctx, target_t *target, int pass)
+{
+    const pass_t *p = &target->passes[pass];
+    int i;
+
+    glGenFramebuffers(1, &target->FramebufferIds[pass]);
+    glBindFramebuffer(GL_FRAMEBUFFER, target->FramebufferIds[pass]);
+    for(i = 0; i < p->nb_planes; i++)
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_RENDERBUFFER, target->RenderbufferIds[p->plane + i]);
+    if(CheckGLError(ctx, "ERROR: Could not generate frame buffer"))
+        return ENOSYS;
 
-    glBindFramebuffer(GL_FRAMEBUFFER, s->FramebufferId);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, s->RenderbufferId);
-    ExitOnGLError(ctx, "ERROR: Could not generate frame buffer and render buffer");
+    glDrawBuffers(p->nb_planes, draw_buffers);
+    if(CheckGLError(ctx, "ERROR: Could not draw to the buffer color attachments"))
+        return ENOSYS;
 
-    glDrawBuffer(GL_COLOR_ATTACHMENT0);
-    ExitOnGLError(ctx, "ERROR: Could not draw to buffer color attachment 0");
+    if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE){
+        av_log(ctx, AV_LOG_ERROR, "[OpenGL] ERROR: frame buffer of pass %d is incomplete\n", pass);
+        return ENOSYS;
+    }
 
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return 0;
 }
 
-void CreateFramebuffer2(AVFilterContext *ctx, int w, int h)
+void DestroyFramebuffer(AVFilterContext *ctx)
 {
     ProjectContext *s = ctx->priv;
+    target_t *target;
+    int i, v;
+
+    for(v = 0; s->targets && v < s->nb_targets; v++){
+        target = &s->targets[v];
+        for(i = 0; i < 3; i++){
+            if(target->RenderbufferIds[i])
+                glDeleteRenderbuffers(1, &target->RenderbufferIds[i]);
+            if(target->FramebufferIds[i])
+                glDeleteFramebuffers(1, &target->FramebufferIds[i]);
+            target->RenderbufferIds[i] = 0;
+            target->FramebufferIds[i] = 0;
+        }
+    }
+    ExitOnGLError(ctx, "ERROR: Could not destroy render buffer and frame buffer");
+}
 
-    glBindRenderbuffer(GL_RENDERBUFFER, s->RenderbufferId2);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_R8, w, h);
+int CreateReadbacks(AVFilterContext *ctx)
+{
+    ProjectContext *s = ctx->priv;
+    target_t *target;
+    int i, v;
 
-    glBindFramebuffer(GL_FRAMEBUFFER, s->FramebufferId2);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, s->RenderbufferId2);
-    ExitOnGLError(ctx, "ERROR: Could not generate frame buffer and render buffer");
+    DestroyReadbacks(ctx);
 
-    glDrawBuffer(GL_COLOR_ATTACHMENT0);
-    ExitOnGLError(ctx, "ERROR: Could not draw to buffer color attachment 0");
+    if(!s->pipeline)
+        return 0;
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    // the planes of all outputs follow each other in one pbo
+    s->rb_size = 0;
+    for(v = 0; v < s->nb_targets; v++){
+        target = &s->targets[v];
+        for(i = 0; i < s->nb_planes; i++){
+            target->rb_offset[i] = s->rb_size;
+            s->rb_size += (i ? (size_t)AV_CEIL_RSHIFT(target->w, s->hsub) * AV_CEIL_RSHIFT(target->h, s->vsub) : (size_t)target->w * target->h) * s->bytes * s->channels[i];
+        }
+    }
+
+    // one extra slot, the current frame is read back before the oldest one is emitted
+    s->nb_readbacks = s->pipeline + 1;
+    s->readbacks = av_mallocz_array(s->nb_readbacks, sizeof(readback_t));
+    if(!s->readbacks)
+        return ENOMEM;
+
+    for(i = 0; i < s->nb_readbacks; i++){
+        if(!(s->readbacks[i].frames = av_mallocz_array(s->nb_targets, sizeof(AVFrame *))))
+            return ENOMEM;
+        glGenBuffers(1, &s->readbacks[i].pbo);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, s->readbacks[i].pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, s->rb_size, NULL, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if(CheckGLError(ctx, "ERROR: Could not create the pixel buffer objects"))
+        return ENOSYS;
+
+    av_log(ctx, AV_LOG_INFO, "[Project Filter] asynchronous readback with %d frame(s) in flight\n", s->pipeline);
+
+    return 0;
 }
 
-void DestroyFramebuffer(AVFilterContext *ctx)
+void DestroyReadbacks(AVFilterContext *ctx)
 {
     ProjectContext *s = ctx->priv;
+    int i, v;
+
+    if(!s->readbacks)
+        return;
+
+    for(i = 0; i < s->nb_readbacks; i++){
+        if(s->readbacks[i].fence)
+            glDeleteSync(s->readbacks[i].fence);
+        if(s->readbacks[i].pbo)
+            glDeleteBuffers(1, &s->readbacks[i].pbo);
+        for(v = 0; s->readbacks[i].frames && v < s->nb_targets; v++)
+            av_frame_free(&s->readbacks[i].frames[v]);
+        av_freep(&s->readbacks[i].frames);
+    }
+    av_freep(&s->readbacks);
+    s->nb_readbacks = 0;
+    s->rb_head = 0;
+    s->rb_queued = 0;
+}
 
-    glDeleteRenderbuffers(1, &s->RenderbufferId);
-    glDeleteFramebuffers(1, &s->FramebufferId);
-    ExitOnGLError(ctx, "ERROR: Could not destroy render buffer and frame buffer");
+// Read the plane rendered in the current framebuffer, either into the frame
+// or into the pbo of the next free readback slot
+void ReadPlane(AVFilterContext *ctx, const target_t *target, AVFrame *frame, int plane, int w, int h)
+{
+    ProjectContext *s = ctx->priv;
+    const int pixel_size = s->bytes * s->channels[plane];
+    readback_t *rb;
+    int i;
+
+    if(!s->pipeline){
+        // write straight into the pool frame, honoring its padded linesize
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        if(frame->linesize[plane] % pixel_size){
+            for(i = 0; i < h; i++)
+                glReadPixels(0, i, w, 1, s->PixelFormats[plane], s->PixelType, frame->data[plane] + i * frame->linesize[plane]);
+        }else{
+            glPixelStorei(GL_PACK_ROW_LENGTH, frame->linesize[plane] / pixel_size);
+            glReadPixels(0, 0, w, h, s->PixelFormats[plane], s->PixelType, frame->data[plane]);
+            glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+        }
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        ExitOnGLError(ctx, "ERROR: Could not read pixel");
+        return;
+    }
+
+    rb = &s->readbacks[(s->rb_head + s->rb_queued) % s->nb_readbacks];
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, rb->pbo);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, w, h, s->PixelFormats[plane], s->PixelType, (GLvoid *)target->rb_offset[plane]);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    ExitOnGLError(ctx, "ERROR: Could not read pixel into the pixel buffer object");
+}
+
+// Takes ownership of the frames of all outputs
+int QueueReadback(AVFilterContext *ctx, AVFrame **frames)
+{
+    ProjectContext *s = ctx->priv;
+    readback_t *rb = &s->readbacks[(s->rb_head + s->rb_queued) % s->nb_readbacks];
+    int v;
+
+    for(v = 0; v < s->nb_targets; v++){
+        rb->frames[v] = frames[v];
+        frames[v] = NULL;
+    }
+    rb->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glFlush();
+    s->rb_queued++;
+
+    return FlushReadbacks(ctx, s->pipeline);
+}
+
+// Free the frames of the oldest readback slot and mark it free
+static void drop_readback(ProjectContext *s)
+{
+    readback_t *rb = &s->readbacks[s->rb_head];
+    int v;
+
+    for(v = 0; v < s->nb_targets; v++)
+        av_frame_free(&rb->frames[v]);
+    s->rb_head = (s->rb_head + 1) % s->nb_readbacks;
+    s->rb_queued--;
+}
+
+// Emit the oldest queued frames until at most max_queued are left in flight
+int FlushReadbacks(AVFilterContext *ctx, int max_queued)
+{
+    ProjectContext *s = ctx->priv;
+    const target_t *target;
+    readback_t *rb;
+    AVFrame *frame;
+    const uint8_t *src;
+    GLenum status;
+    int i, v, w, h, ret = 0;
+
+    while(s->rb_queued > max_queued){
+        rb = &s->readbacks[s->rb_head];
+
+        while((status = glClientWaitSync(rb->fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000)) == GL_TIMEOUT_EXPIRED)
+            av_log(ctx, AV_LOG_WARNING, "[Project Filter] still waiting for the readback to complete\n");
+        glDeleteSync(rb->fence);
+        rb->fence = 0;
+        if(status == GL_WAIT_FAILED){
+            av_log(ctx, AV_LOG_ERROR, "[OpenGL] ERROR: Could not wait for the readback to complete\n");
+            drop_readback(s);
+            return AVERROR_EXTERNAL;
+        }
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, rb->pbo);
+        src = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, s->rb_size, GL_MAP_READ_BIT);
+        if(!src){
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            av_log(ctx, AV_LOG_ERROR, "[OpenGL] ERROR: Could not map the pixel buffer object\n");
+            drop_readback(s);
+            return AVERROR_EXTERNAL;
+        }
+
+        for(v = 0; v < s->nb_targets; v++){
+            target = &s->targets[v];
+            frame = rb->frames[v];
+            for(i = 0; i < s->nb_planes; i++){
+                w = (i ? AV_CEIL_RSHIFT(target->w, s->hsub) : target->w) * s->bytes * s->channels[i];
+                h = i ? AV_CEIL_RSHIFT(target->h, s->vsub) : target->h;
+                av_image_copy_plane(frame->data[i], frame->linesize[i], src + target->rb_offset[i], w, w, h);
+            }
+        }
+
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        // after a failed output, the frames not sent yet are freed with the slot
+        for(v = 0; v < s->nb_targets && ret >= 0; v++){
+            frame = rb->frames[v];
+            rb->frames[v] = NULL;
+            ret = ff_filter_frame(ctx->outputs[v], frame);
+        }
+        drop_readback(s);
+        if(ret < 0)
+            return ret;
+    }
+
+    return 0;
 }
 
 void printPixelFormat(AVFilterContext *ctx, const AVPixFmtDescriptor *desc)
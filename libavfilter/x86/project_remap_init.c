@@ -0,0 +1,226 @@
+#include "config.h"
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/x86/cpu.h"
+#include "libavfilter/project_remap.h"
+
+#if HAVE_SSE4_INLINE || HAVE_AVX2_INLINE
+#include <immintrin.h>
+#endif
+
+#if HAVE_SSE4_INLINE
+// 4 pixels at a time, the texels are fetched one by one
+static __attribute__((target("sse4.1")))
+void remap_line_sse4(uint8_t *dst, const uint8_t *src, ptrdiff_t linesize,
+                     const float *lut, int w, int src_w, int src_h)
+{
+    const __m128i max_x = _mm_set1_epi32(src_w - 2), max_y = _mm_set1_epi32(src_h - 2);
+    const __m128i stride = _mm_set1_epi32(linesize);
+    const __m128i mask = _mm_set1_epi32(0xff);
+    const __m128 zero = _mm_setzero_ps(), half = _mm_set1_ps(0.5f);
+    int32_t off[4];
+    int i;
+
+    for(i = 0; i + 4 <= w; i += 4, lut += 8){
+        const __m128 a = _mm_loadu_ps(lut), b = _mm_loadu_ps(lut + 4);
+        __m128 x = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 y = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        const __m128i covered = _mm_castps_si128(_mm_cmpge_ps(x, zero));
+        __m128i x0, y0, t, bt, res;
+        __m128 fx, fy, p00, p01, p10, p11, top, bottom;
+
+        x = _mm_max_ps(x, zero);
+        y = _mm_max_ps(y, zero);
+        x0 = _mm_min_epi32(_mm_cvttps_epi32(x), max_x);
+        y0 = _mm_min_epi32(_mm_cvttps_epi32(y), max_y);
+        fx = _mm_sub_ps(x, _mm_cvtepi32_ps(x0));
+        fy = _mm_sub_ps(y, _mm_cvtepi32_ps(y0));
+        _mm_storeu_si128((__m128i *)off, _mm_add_epi32(_mm_mullo_epi32(y0, stride), x0));
+
+        t  = _mm_setr_epi32(AV_RN16(src + off[0]), AV_RN16(src + off[1]),
+                            AV_RN16(src + off[2]), AV_RN16(src + off[3]));
+        bt = _mm_setr_epi32(AV_RN16(src + linesize + off[0]), AV_RN16(src + linesize + off[1]),
+                            AV_RN16(src + linesize + off[2]), AV_RN16(src + linesize + off[3]));
+        p00 = _mm_cvtepi32_ps(_mm_and_si128(t, mask));
+        p01 = _mm_cvtepi32_ps(_mm_srli_epi32(t, 8));
+        p10 = _mm_cvtepi32_ps(_mm_and_si128(bt, mask));
+        p11 = _mm_cvtepi32_ps(_mm_srli_epi32(bt, 8));
+
+        top = _mm_add_ps(p00, _mm_mul_ps(fx, _mm_sub_ps(p01, p00)));
+        bottom = _mm_add_ps(p10, _mm_mul_ps(fx, _mm_sub_ps(p11, p10)));
+        res = _mm_cvttps_epi32(_mm_add_ps(_mm_add_ps(top, _mm_mul_ps(fy, _mm_sub_ps(bottom, top))), half));
+        res = _mm_and_si128(res, covered);
+        res = _mm_packus_epi32(res, res);
+        res = _mm_packus_epi16(res, res);
+        AV_WN32(dst + i, _mm_cvtsi128_si32(res));
+    }
+
+    ff_project_remap_line_c(dst + i, src, linesize, lut, w - i, src_w, src_h);
+}
+
+// the same in integers, from 12.4 coordinates
+static __attribute__((target("sse4.1")))
+void remap_line_fixed_sse4(uint8_t *dst, const uint8_t *src, ptrdiff_t linesize,
+                           const uint16_t *lut, int w, int src_w, int src_h)
+{
+    const __m128i max_x = _mm_set1_epi32(src_w - 2), max_y = _mm_set1_epi32(src_h - 2);
+    const __m128i stride = _mm_set1_epi32(linesize);
+    const __m128i mask = _mm_set1_epi32(0xff), low = _mm_set1_epi32(0xffff);
+    const __m128i uncovered = _mm_set1_epi32(PROJECT_REMAP_UNCOVERED);
+    const __m128i round = _mm_set1_epi32(1 << (2 * PROJECT_REMAP_FRAC_BITS - 1));
+    int32_t off[4];
+    int i;
+
+    for(i = 0; i + 4 <= w; i += 4, lut += 8){
+        const __m128i xy = _mm_loadu_si128((const __m128i *)lut);
+        const __m128i x = _mm_and_si128(xy, low), y = _mm_srli_epi32(xy, 16);
+        const __m128i covered = _mm_xor_si128(_mm_cmpeq_epi32(x, uncovered), _mm_set1_epi32(-1));
+        __m128i x0, y0, fx, fy, t, bt, p00, p01, p10, p11, top, bottom, res;
+
+        x0 = _mm_min_epi32(_mm_srli_epi32(x, PROJECT_REMAP_FRAC_BITS), max_x);
+        y0 = _mm_min_epi32(_mm_srli_epi32(y, PROJECT_REMAP_FRAC_BITS), max_y);
+        fx = _mm_sub_epi32(x, _mm_slli_epi32(x0, PROJECT_REMAP_FRAC_BITS));
+        fy = _mm_sub_epi32(y, _mm_slli_epi32(y0, PROJECT_REMAP_FRAC_BITS));
+        _mm_storeu_si128((__m128i *)off, _mm_add_epi32(_mm_mullo_epi32(y0, stride), x0));
+
+        t  = _mm_setr_epi32(AV_RN16(src + off[0]), AV_RN16(src + off[1]),
+                            AV_RN16(src + off[2]), AV_RN16(src + off[3]));
+        bt = _mm_setr_epi32(AV_RN16(src + linesize + off[0]), AV_RN16(src + linesize + off[1]),
+                            AV_RN16(src + linesize + off[2]), AV_RN16(src + linesize + off[3]));
+        p00 = _mm_and_si128(t, mask);
+        p01 = _mm_srli_epi32(t, 8);
+        p10 = _mm_and_si128(bt, mask);
+        p11 = _mm_srli_epi32(bt, 8);
+
+        top = _mm_add_epi32(_mm_slli_epi32(p00, PROJECT_REMAP_FRAC_BITS), _mm_mullo_epi32(fx, _mm_sub_epi32(p01, p00)));
+        bottom = _mm_add_epi32(_mm_slli_epi32(p10, PROJECT_REMAP_FRAC_BITS), _mm_mullo_epi32(fx, _mm_sub_epi32(p11, p10)));
+        res = _mm_add_epi32(_mm_slli_epi32(top, PROJECT_REMAP_FRAC_BITS), _mm_mullo_epi32(fy, _mm_sub_epi32(bottom, top)));
+        res = _mm_srli_epi32(_mm_add_epi32(res, round), 2 * PROJECT_REMAP_FRAC_BITS);
+        res = _mm_and_si128(res, covered);
+        res = _mm_packus_epi32(res, res);
+        res = _mm_packus_epi16(res, res);
+        AV_WN32(dst + i, _mm_cvtsi128_si32(res));
+    }
+
+    ff_project_remap_line_fixed_c(dst + i, src, linesize, lut, w - i, src_w, src_h);
+}
+#endif
+
+#if HAVE_AVX2_INLINE
+// 8 pixels at a time, each gather fetches two horizontal neighbours at once
+static __attribute__((target("avx2")))
+void remap_line_avx2(uint8_t *dst, const uint8_t *src, ptrdiff_t linesize,
+                     const float *lut, int w, int src_w, int src_h)
+{
+    const __m256i max_x = _mm256_set1_epi32(src_w - 2), max_y = _mm256_set1_epi32(src_h - 2);
+    const __m256i stride = _mm256_set1_epi32(linesize);
+    const __m256i mask = _mm256_set1_epi32(0xff);
+    const __m256 zero = _mm256_setzero_ps(), half = _mm256_set1_ps(0.5f);
+    int i;
+
+    for(i = 0; i + 8 <= w; i += 8, lut += 16){
+        const __m256 a = _mm256_loadu_ps(lut), b = _mm256_loadu_ps(lut + 8);
+        // x0 x1 x4 x5 | x2 x3 x6 x7, put back in order
+        __m256 x = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(
+                       _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0))), _MM_SHUFFLE(3, 1, 2, 0)));
+        __m256 y = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(
+                       _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))), _MM_SHUFFLE(3, 1, 2, 0)));
+        const __m256i covered = _mm256_castps_si256(_mm256_cmp_ps(x, zero, _CMP_GE_OQ));
+        __m256i x0, y0, off, t, bt, res;
+        __m256 fx, fy, p00, p01, p10, p11, top, bottom;
+        __m128i packed;
+
+        x = _mm256_max_ps(x, zero);
+        y = _mm256_max_ps(y, zero);
+        x0 = _mm256_min_epi32(_mm256_cvttps_epi32(x), max_x);
+        y0 = _mm256_min_epi32(_mm256_cvttps_epi32(y), max_y);
+        fx = _mm256_sub_ps(x, _mm256_cvtepi32_ps(x0));
+        fy = _mm256_sub_ps(y, _mm256_cvtepi32_ps(y0));
+        off = _mm256_add_epi32(_mm256_mullo_epi32(y0, stride), x0);
+
+        t  = _mm256_i32gather_epi32((const int *)src, off, 1);
+        bt = _mm256_i32gather_epi32((const int *)(src + linesize), off, 1);
+        p00 = _mm256_cvtepi32_ps(_mm256_and_si256(t, mask));
+        p01 = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(t, 8), mask));
+        p10 = _mm256_cvtepi32_ps(_mm256_and_si256(bt, mask));
+        p11 = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(bt, 8), mask));
+
+        top = _mm256_add_ps(p00, _mm256_mul_ps(fx, _mm256_sub_ps(p01, p00)));
+        bottom = _mm256_add_ps(p10, _mm256_mul_ps(fx, _mm256_sub_ps(p11, p10)));
+        res = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_add_ps(top, _mm256_mul_ps(fy, _mm256_sub_ps(bottom, top))), half));
+        res = _mm256_and_si256(res, covered);
+        packed = _mm_packus_epi32(_mm256_castsi256_si128(res), _mm256_extracti128_si256(res, 1));
+        packed = _mm_packus_epi16(packed, packed);
+        _mm_storel_epi64((__m128i *)(dst + i), packed);
+    }
+
+    ff_project_remap_line_c(dst + i, src, linesize, lut, w - i, src_w, src_h);
+}
+
+static __attribute__((target("avx2")))
+void remap_line_fixed_avx2(uint8_t *dst, const uint8_t *src, ptrdiff_t linesize,
+                           const uint16_t *lut, int w, int src_w, int src_h)
+{
+    const __m256i max_x = _mm256_set1_epi32(src_w - 2), max_y = _mm256_set1_epi32(src_h - 2);
+    const __m256i stride = _mm256_set1_epi32(linesize);
+    const __m256i mask = _mm256_set1_epi32(0xff), low = _mm256_set1_epi32(0xffff);
+    const __m256i uncovered = _mm256_set1_epi32(PROJECT_REMAP_UNCOVERED);
+    const __m256i round = _mm256_set1_epi32(1 << (2 * PROJECT_REMAP_FRAC_BITS - 1));
+    int i;
+
+    for(i = 0; i + 8 <= w; i += 8, lut += 16){
+        const __m256i xy = _mm256_loadu_si256((const __m256i *)lut);
+        const __m256i x = _mm256_and_si256(xy, low), y = _mm256_srli_epi32(xy, 16);
+        const __m256i covered = _mm256_xor_si256(_mm256_cmpeq_epi32(x, uncovered), _mm256_set1_epi32(-1));
+        __m256i x0, y0, fx, fy, off, t, bt, p00, p01, p10, p11, top, bottom, res;
+        __m128i packed;
+
+        x0 = _mm256_min_epi32(_mm256_srli_epi32(x, PROJECT_REMAP_FRAC_BITS), max_x);
+        y0 = _mm256_min_epi32(_mm256_srli_epi32(y, PROJECT_REMAP_FRAC_BITS), max_y);
+        fx = _mm256_sub_epi32(x, _mm256_slli_epi32(x0, PROJECT_REMAP_FRAC_BITS));
+        fy = _mm256_sub_epi32(y, _mm256_slli_epi32(y0, PROJECT_REMAP_FRAC_BITS));
+        // uncovered pixels fetch from the clamped position and are masked out
+        off = _mm256_add_epi32(_mm256_mullo_epi32(y0, stride), x0);
+
+        t  = _mm256_i32gather_epi32((const int *)src, off, 1);
+        bt = _mm256_i32gather_epi32((const int *)(src + linesize), off, 1);
+        p00 = _mm256_and_si256(t, mask);
+        p01 = _mm256_and_si256(_mm256_srli_epi32(t, 8), mask);
+        p10 = _mm256_and_si256(bt, mask);
+        p11 = _mm256_and_si256(_mm256_srli_epi32(bt, 8), mask);
+
+        top = _mm256_add_epi32(_mm256_slli_epi32(p00, PROJECT_REMAP_FRAC_BITS), _mm256_mullo_epi32(fx, _mm256_sub_epi32(p01, p00)));
+        bottom = _mm256_add_epi32(_mm256_slli_epi32(p10, PROJECT_REMAP_FRAC_BITS), _mm256_mullo_epi32(fx, _mm256_sub_epi32(p11, p10)));
+        res = _mm256_add_epi32(_mm256_slli_epi32(top, PROJECT_REMAP_FRAC_BITS), _mm256_mullo_epi32(fy, _mm256_sub_epi32(bottom, top)));
+        res = _mm256_srli_epi32(_mm256_add_epi32(res, round), 2 * PROJECT_REMAP_FRAC_BITS);
+        res = _mm256_and_si256(res, covered);
+        packed = _mm_packus_epi32(_mm256_castsi256_si128(res), _mm256_extracti128_si256(res, 1));
+        packed = _mm_packus_epi16(packed, packed);
+        _mm_storel_epi64((__m128i *)(dst + i), packed);
+    }
+
+    ff_project_remap_line_fixed_c(dst + i, src, linesize, lut, w - i, src_w, src_h);
+}
+#endif
+
+av_cold void ff_project_remap_init_x86(ProjectRemapContext *r)
+{
+    int cpu_flags = av_get_cpu_flags();
+
+#if HAVE_SSE4_INLINE
+    if(INLINE_SSE4(cpu_flags)){
+        r->remap_line = remap_line_sse4;
+        r->remap_line_padded = remap_line_sse4;
+        r->remap_line_fixed = remap_line_fixed_sse4;
+        r->remap_line_fixed_padded = remap_line_fixed_sse4;
+    }
+#endif
+#if HAVE_AVX2_INLINE
+    // the gathers read 4 bytes from the left texel on
+    if(INLINE_AVX2(cpu_flags)){
+        r->remap_line_padded = remap_line_avx2;
+        r->remap_line_fixed_padded = remap_line_fixed_avx2;
+    }
+#endif
+}
@@ -0,0 +1,46 @@
+#!/usr/bin/perl
+
+use 5.018;
+use strict;
+use warnings;
+
+my ($in, $out); # text orientation trace, binary orientation trace
+
+for my $arg (@ARGV) {
+    $in = $1 if $arg =~ /in=([^\s]+)/;
+    $out = $1 if $arg =~ /out=([^\s]+)/;
+}
+
+if( !defined $in or !defined $out ) {
+    say "Must specify options for in/out!";
+    &usage();
+    exit;
+}
+
+open my $ifh, '<', $in or die "Cannot open $in: $!";
+
+my @samples;
+while (my $line = <$ifh>) {
+    my @args = split ' ', $line;
+    next unless @args;
+    die "$in line $.: expected 4 fields, got " . scalar(@args) . "\n" unless @args == 4;
+    # time, frame, x-rotation, y-rotation; there is no z-rotation in the text format
+    push @samples, [ $args[0], $args[2], $args[3], 0.0 ];
+}
+close $ifh;
+
+@samples = sort { $a->[0] <=> $b->[0] } @samples;
+
+open my $ofh, '>:raw', $out or die "Cannot open $out: $!";
+print $ofh "P360ORB1", pack('Q<', scalar @samples);
+print $ofh pack('d<4', @$_) for @samples;
+close $ofh;
+
+say "Wrote " . scalar(@samples) . " samples to $out";
+
+sub usage {
+    say 'usage: ./orconvert.pl $option=value';
+    say 'options:';
+    say '  in: orientation file in text format';
+    say '  out: orientation file in binary format';
+}
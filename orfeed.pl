@@ -0,0 +1,81 @@
+#!/usr/bin/perl
+
+use 5.018;
+use strict;
+use warnings;
+
+use IO::Socket::UNIX;
+use POSIX qw/mkfifo/;
+use Time::HiRes qw/time sleep/;
+
+my ($or, $feed, $type, $speed); # orientation file, feed path, socket or fifo, playback speed
+
+for my $arg (@ARGV) {
+    $or = $1 if $arg =~ /or=([^\s]+)/;
+    $feed = $1 if $arg =~ /feed=([^\s]+)/;
+    $type = $1 if $arg =~ /type=([^\s]+)/;
+    $speed = $1 if $arg =~ /speed=([^\s]+)/;
+}
+
+if( !defined $or or !defined $feed ) {
+    say "Must specify options for or/feed!";
+    &usage();
+    exit;
+}
+
+$type = "socket" if !defined $type or $type !~ /^(socket|fifo)$/;
+$speed = 1.0 unless defined $speed and $speed > 0;
+
+# same text format as the orfile option: time, frame, x-rotation, y-rotation
+open my $fh, '<', $or or die "Cannot open $or: $!";
+my @samples;
+while (my $line = <$fh>) {
+    my @args = split ' ', $line;
+    next unless @args == 4;
+    push @samples, [ $args[0], $args[2], $args[3] ];
+}
+close $fh;
+die "No samples in $or\n" unless @samples;
+
+$SIG{PIPE} = 'IGNORE';
+unlink $feed if -S $feed;
+
+if ($type eq "fifo") {
+    mkfifo($feed, 0600) or die "Cannot create fifo $feed: $!" unless -p $feed;
+    # blocks until the filter opens the fifo
+    open my $out, '>', $feed or die "Cannot open $feed: $!";
+    $out->autoflush(1);
+    replay($out);
+    close $out;
+} else {
+    my $server = IO::Socket::UNIX->new(Type => SOCK_STREAM(), Local => $feed, Listen => 1)
+        or die "Cannot listen on $feed: $!";
+    say "Waiting for the filter on $feed";
+    while (my $client = $server->accept()) {
+        $client->autoflush(1);
+        replay($client);
+        close $client;
+    }
+}
+
+# send the samples as "yaw pitch roll" lines at the pace of their timestamps
+sub replay {
+    my ($out) = @_;
+    my $start = time;
+
+    for my $sample (@samples) {
+        my $delay = $start + ($sample->[0] - $samples[0][0]) / $speed - time;
+        sleep $delay if $delay > 0;
+        print $out "$sample->[2] $sample->[1] 0\n" or return;
+    }
+    say "Replayed " . scalar(@samples) . " samples";
+}
+
+sub usage {
+    say 'usage: ./orfeed.pl $option=value';
+    say 'options (default values):';
+    say '  or: orientation file to replay';
+    say '  feed: path of the socket or fifo';
+    say '  type: socket or fifo (socket)';
+    say '  speed: playback speed (1.0)';
+}
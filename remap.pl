@@ -107,66 +107,19 @@ sub check_overlap {
 
 
 my $prefix_args = "-y -loglevel 'info' -i $iv";
-my $filter_args = "-filter_complex \"nullsrc=";
-unless($iv =~ /(\.jpg|\.bmp)/){
-    $filter_args .= "rate=$fps:";
-}
-$filter_args .= "size=${ow}x${oh} [base];";
-my ($project_args, $overlay_args);
-
-for(my $i = 0; $i < @ol; $i++){
-    # w:h:xfov:yfov:xr:yr:zr:u:v
-    # 0:1:2   :3   :4 :5 :6 :7:8
-    my @args = split /:/, $ol[$i];
-
-    my $w = int($args[0] * $ow);
-    my $h = int($args[1] * $oh);
-    my $x = int($args[7] * $ow);
-    my $y = int($args[8] * $oh);
-    my $xfov = $args[2];
-    my $yfov = $args[3];
-    my $others = join ":", @args[4 .. 6];
-
-    if($w % 8 != 0){
-        $w += (8 - $w % 8);
-    }
-
-    if($h % 8 != 0){
-        $h += (8 - $h % 8);
-    }
-
-    if($x % 8 != 0){
-        $x += (8 - $x % 8);
-    }
-
-    if($y % 8 != 0){
-        $y += (8 - $y % 8);
-    }
 
-
-    my $proj_arg = join ":", ($w, $h, $xfov, $yfov, $others, $ovs, $ofs, "", $il);
-    $proj_arg .= ":0:${ecoef}" if defined $ecoef;
-    $project_args .= "[0:v] project=${proj_arg} [pos${i}]; ";
-
-    if($i == 0){
-        $overlay_args .= "[base][pos${i}] overlay=shortest=1:x=${x}:y=${y}";
-    }else{
-        $overlay_args .= ("[tmp" . ($i-1) . "][pos${i}] overlay=shortest=1:x=${x}:y=${y}");
-    }
-
-    if($i != $#ol){
-        $overlay_args .= " [tmp${i}]; ";
-    }else{
-        $overlay_args .= "\"";
-    }
-
-    say $proj_arg;
-
-}
+# a single project filter renders all tiles of the output layout into one ${ow}x${oh} frame,
+# placing them at 8 pixel aligned positions; it is given the path of the layout checked above,
+# since the filter opens names with a '/' as they are and looks other names up among its own
+my $olofile = $ol =~ m{/} ? $ol : "./$ol";
+my $proj_arg = join ":", ("w=$ow", "h=$oh", "vshader=$ovs", "fshader=$ofs", "lofile=$il", "olofile=$olofile", "align=8");
+$proj_arg .= ":ecoef=${ecoef}" if defined $ecoef;
+my $filter_args = "-filter:v \"project=${proj_arg}\"";
+say $proj_arg;
 
 if(!$two_pass){
     my $ffmpeg_cmd;
-    $ffmpeg_cmd = join " ", ("./ffmpeg", $prefix_args, $filter_args, $project_args, $overlay_args, $q_arg, $ov);
+    $ffmpeg_cmd = join " ", ("./ffmpeg", $prefix_args, $filter_args, $q_arg, $ov);
     say $ffmpeg_cmd;
 
     open my $cmd_fh, "$ffmpeg_cmd |";
@@ -175,7 +128,7 @@ if(!$two_pass){
     }
     close $cmd_fh;
 }else{
-    my $ffmpeg_cmd1 = join " ", ("./ffmpeg", $prefix_args, $filter_args, $project_args, $overlay_args, $q_arg, $cbr, "-pass 1 -f mp4 /dev/null");
+    my $ffmpeg_cmd1 = join " ", ("./ffmpeg", $prefix_args, $filter_args, $q_arg, $cbr, "-pass 1 -f mp4 /dev/null");
     say $ffmpeg_cmd1;
 
     open my $cmd_fh1, "$ffmpeg_cmd1 |";
@@ -184,7 +137,7 @@ if(!$two_pass){
     }
     close $cmd_fh1;
 
-    my $ffmpeg_cmd2 = join " ", ("./ffmpeg", $prefix_args, $filter_args, $project_args, $overlay_args, $q_arg, $cbr, "-pass 2", $ov);
+    my $ffmpeg_cmd2 = join " ", ("./ffmpeg", $prefix_args, $filter_args, $q_arg, $cbr, "-pass 2", $ov);
     say $ffmpeg_cmd2;
 
     open my $cmd_fh2, "$ffmpeg_cmd2 |";